@@ -0,0 +1,140 @@
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QFile>
+#include <QtDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <linux/input.h>
+
+#include "accelerometer.h"
+
+Accelerometer::Accelerometer(StepDetector *det, QObject *parent) : QObject(parent)
+{
+	detector= det;
+	enabled= false;
+	fd= -1;
+	notifier= NULL;
+	ax= ay= az= 0;
+	base_sec= -1;
+	replay_file= NULL;
+	replay_timer= NULL;
+	replay_base= -1;
+	have_next= false;
+}
+
+Accelerometer::~Accelerometer()
+{
+	if(fd >= 0)
+		::close(fd);
+}
+
+bool Accelerometer::openDevice(const QString &path)
+{
+	fd= ::open(QFile::encodeName(path), O_RDONLY | O_NONBLOCK);
+	if(fd < 0){
+		qDebug("Cannot open accelerometer %s", (const char *)path.toAscii());
+		return false;
+	}
+	notifier= new QSocketNotifier(fd, QSocketNotifier::Read, this);
+	notifier->setEnabled(enabled);
+	connect(notifier, SIGNAL(activated(int)), this, SLOT(readDevice()));
+	return true;
+}
+
+bool Accelerometer::openReplay(const QString &path)
+{
+	replay_file= new QFile(path, this);
+	if(!replay_file->open(QIODevice::ReadOnly | QIODevice::Text)){
+		qDebug("Cannot open accelerometer replay %s", (const char *)path.toAscii());
+		return false;
+	}
+	replay_timer= new QTimer(this);
+	connect(replay_timer, SIGNAL(timeout()), this, SLOT(replay()));
+	replay_timer->setInterval(20);
+	return true;
+}
+
+void Accelerometer::setEnabled(bool flg)
+{
+	enabled= flg;
+	if(notifier != NULL){
+		// throw away whatever queued up while we were not listening
+		if(enabled){
+			struct input_event events[16];
+			while(::read(fd, events, sizeof(events)) > 0)
+				;
+		}
+		notifier->setEnabled(enabled);
+	}
+
+	if(replay_timer != NULL){
+		if(enabled){
+			// carry on from where the file was paused
+			replay_clock.start();
+			replay_base= have_next ? next_ms : -1;
+			replay_timer->start();
+		}else
+			replay_timer->stop();
+	}
+}
+
+// Each axis arrives as its own event, the sample is complete at the sync event
+void Accelerometer::readDevice()
+{
+	struct input_event events[16];
+	int n;
+	bool step= false;
+	while((n= ::read(fd, events, sizeof(events))) > 0){
+		for(int i= 0; i < n / (int)sizeof(struct input_event); i++){
+			const struct input_event &ev= events[i];
+			if(ev.type == EV_ABS || ev.type == EV_REL){
+				if(ev.code == 0) ax= ev.value;
+				else if(ev.code == 1) ay= ev.value;
+				else if(ev.code == 2) az= ev.value;
+			}else if(ev.type == EV_SYN){
+				if(base_sec < 0)
+					base_sec= ev.time.tv_sec;
+				int ms= (ev.time.tv_sec - base_sec) * 1000 + ev.time.tv_usec / 1000;
+				step |= detector->sample(ms, ax, ay, az);
+			}
+		}
+	}
+
+	if(step)
+		emit stepped();
+}
+
+// feed all the samples from the file that are due by now
+void Accelerometer::replay()
+{
+	bool step= false;
+	char line[128];
+	for(;;){
+		if(!have_next){
+			if(replay_file->readLine(line, sizeof(line)) <= 0){
+				qDebug("accelerometer replay finished");
+				replay_timer->stop();
+				break;
+			}
+			if(sscanf(line, "%d %d %d %d", &next_ms, &next_x, &next_y, &next_z) != 4)
+				continue;
+			have_next= true;
+		}
+
+		// line the clock up with the file time
+		if(replay_base < 0){
+			replay_base= next_ms;
+			replay_clock.start();
+		}
+		if(next_ms > replay_base + replay_clock.elapsed())
+			break;
+
+		step |= detector->sample(next_ms, next_x, next_y, next_z);
+		have_next= false;
+	}
+
+	if(step)
+		emit stepped();
+}
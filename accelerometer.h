@@ -0,0 +1,51 @@
+#ifndef ACCELEROMETER_H
+#define ACCELEROMETER_H
+
+#include <QObject>
+#include <QTime>
+
+#include "stepdetector.h"
+
+class QSocketNotifier;
+class QTimer;
+class QFile;
+
+// Feeds accelerometer samples to a StepDetector, either from a Linux
+// input event device or by replaying a recorded file of lines
+// "<ms> <x> <y> <z>" with x, y and z in mg
+class Accelerometer : public QObject
+{
+	Q_OBJECT
+
+ public:
+	Accelerometer(StepDetector *detector, QObject *parent = 0);
+	~Accelerometer();
+	bool openDevice(const QString &path);
+	bool openReplay(const QString &path);
+	void setEnabled(bool);
+
+ signals:
+	void stepped();
+
+ private slots:
+	void readDevice();
+	void replay();
+
+ private:
+	StepDetector *detector;
+	bool enabled;
+
+	int fd;
+	QSocketNotifier *notifier;
+	int ax, ay, az;
+	long base_sec;
+
+	QFile *replay_file;
+	QTimer *replay_timer;
+	QTime replay_clock;
+	int replay_base;		// file time when replay_clock was started
+	int next_ms, next_x, next_y, next_z;
+	bool have_next;
+};
+
+#endif
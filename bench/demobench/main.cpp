@@ -0,0 +1,184 @@
+// Times terrain elevation lookups over synthetic SRTM tiles, inside one
+// tile, going back and forth across tile boundaries, on a tile not yet
+// opened and for a whole track at once, and checks the heights. Exits
+// with 1 if any height is wrong or any lookup is over its budget.
+//
+//   > demobench [max ns per lookup] [max us per cold tile]
+//
+// defaults to 400 ns and 100 us, a few times what a PC takes, pass
+// bigger budgets on the phone. The tiles are written to the temp
+// directory and removed afterwards, so a cold tile is one the Terrain has
+// not opened, the file itself is in the page cache.
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QVector>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "terrain.h"
+
+#define PI 3.14159265358979
+// 3 arc second tiles
+#define TILE_SIZE 1201
+#define LOOKUPS 1000000
+#define TRACK_POINTS 100000
+#define COLD_RUNS 20
+
+static qint64 nsecs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (qint64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// the terrain is a slope of 1 m per post east and north from 49N 124W,
+// which bilinear interpolation gives back exactly anywhere
+static double height(double lat, double longit)
+{
+	return (lat - 49.0 + longit + 124.0) * (TILE_SIZE - 1);
+}
+
+static bool writeTile(const QString &dir, int lat, int longit)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "N%02dW%03d.hgt", lat, -longit);
+	FILE *fp= fopen(QFile::encodeName(dir + "/" + name), "wb");
+	if(fp == NULL)
+		return false;
+	for(int row= 0; row < TILE_SIZE; row++){
+		for(int col= 0; col < TILE_SIZE; col++){
+			int h= (int)floor(height(lat + 1 - row / (double)(TILE_SIZE - 1), longit + col / (double)(TILE_SIZE - 1)) + 0.5);
+			fputc((h >> 8) & 0xff, fp);
+			fputc(h & 0xff, fp);
+		}
+	}
+	return fclose(fp) == 0;
+}
+
+static void removeTile(const QString &dir, int lat, int longit)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "N%02dW%03d.hgt", lat, -longit);
+	QFile::remove(dir + "/" + name);
+}
+
+// a random point in the 2 x 2 degrees from 49N 124W, or in the one tile
+static void randomPoint(double &lat, double &longit, int tiles)
+{
+	lat= 49.0 + (rand() / (RAND_MAX + 1.0)) * tiles;
+	longit= -124.0 + (rand() / (RAND_MAX + 1.0)) * tiles;
+}
+
+// checks the heights, returns how many are wrong
+static int check(const double *lat, const double *longit, const double *alt, int n)
+{
+	int wrong= 0;
+	for(int i= 0; i < n; i++){
+		if(fabs(alt[i] - height(lat[i], longit[i])) > 0.01)
+			wrong++;
+	}
+	return wrong;
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	int max_ns= argc > 1 ? atoi(argv[1]) : 400;
+	int max_cold_us= argc > 2 ? atoi(argv[2]) : 100;
+
+	QString dir= QDir::tempPath() + "/demobench";
+	QDir().mkpath(dir);
+	for(int lat= 49; lat <= 50; lat++){
+		for(int longit= -124; longit <= -123; longit++){
+			if(!writeTile(dir, lat, longit)){
+				fprintf(stderr, "Cannot write tiles to %s\n", (const char *)dir.toAscii());
+				return 2;
+			}
+		}
+	}
+
+	QVector<double> lats(LOOKUPS), longs(LOOKUPS), alts(LOOKUPS);
+	int failures= 0;
+	printf("%-8s %8s %10s %8s\n", "lookups", "count", "ns each", "wrong");
+
+	// one at a time, as each fix arrives, all in one tile then spread over
+	// four so each lookup is likely in a different tile from the last
+	for(int tiles= 1; tiles <= 2; tiles++){
+		srand(tiles);
+		for(int i= 0; i < LOOKUPS; i++)
+			randomPoint(lats[i], longs[i], tiles);
+
+		Terrain terrain(dir);
+		double alt;
+		terrain.elevation(lats[0], longs[0], alt);
+		qint64 t= nsecs();
+		for(int i= 0; i < LOOKUPS; i++)
+			terrain.elevation(lats[i], longs[i], alts[i]);
+		double ns= (nsecs() - t) / (double)LOOKUPS;
+
+		int wrong= check(lats.constData(), longs.constData(), alts.constData(), LOOKUPS);
+		bool fail= wrong > 0 || ns > max_ns;
+		if(fail)
+			failures++;
+		printf("%-8s %8d %10.1f %8d%s\n", tiles == 1 ? "inside" : "across", LOOKUPS, ns, wrong, fail ? "  FAIL" : "");
+	}
+
+	// the first lookup in a tile maps it
+	{
+		qint64 total= 0;
+		int wrong= 0;
+		for(int i= 0; i < COLD_RUNS; i++){
+			Terrain terrain(dir);
+			double lat, longit, alt= 0.0;
+			randomPoint(lat, longit, 2);
+			qint64 t= nsecs();
+			terrain.elevation(lat, longit, alt);
+			total += nsecs() - t;
+			wrong += check(&lat, &longit, &alt, 1);
+		}
+		double us= total / (double)COLD_RUNS / 1000.0;
+		bool fail= wrong > 0 || us > max_cold_us;
+		if(fail)
+			failures++;
+		printf("%-8s %8d %10.1f %8d%s\n", "cold", COLD_RUNS, us * 1000.0, wrong, fail ? "  FAIL" : "");
+	}
+
+	// a whole track, a long walk that crosses from one tile into the others
+	{
+		double lat= 49.995, longit= -123.005;
+		double heading= PI / 4;
+		srand(3);
+		for(int i= 0; i < TRACK_POINTS; i++){
+			heading += ((rand() % 2001) - 1000) / 10000.0;
+			lat += 1.4 * cos(heading) / 111320.0;
+			longit += 1.4 * sin(heading) / (111320.0 * cos(lat * PI / 180.0));
+			lats[i]= lat;
+			longs[i]= longit;
+		}
+
+		Terrain terrain(dir);
+		qint64 t= nsecs();
+		int found= terrain.elevations(lats.constData(), longs.constData(), alts.data(), TRACK_POINTS);
+		double ns= (nsecs() - t) / (double)TRACK_POINTS;
+
+		int wrong= check(lats.constData(), longs.constData(), alts.constData(), TRACK_POINTS) + TRACK_POINTS - found;
+		bool fail= wrong > 0 || ns > max_ns;
+		if(fail)
+			failures++;
+		printf("%-8s %8d %10.1f %8d%s\n", "track", TRACK_POINTS, ns, wrong, fail ? "  FAIL" : "");
+	}
+
+	for(int lat= 49; lat <= 50; lat++){
+		for(int longit= -124; longit <= -123; longit++)
+			removeTile(dir, lat, longit);
+	}
+	QDir().rmdir(dir);
+
+	printf("%d failures\n", failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+TEMPLATE=app
+TARGET=demobench
+
+CONFIG+=qtopia
+DEFINES+=QT_NO_DEBUG_OUTPUT
+# clock_gettime
+LIBS+=-lrt
+
+INCLUDEPATH+=../..
+
+# Input files
+HEADERS=\
+    ../../terrain.h
+
+SOURCES=\
+    main.cpp\
+    ../../terrain.cpp
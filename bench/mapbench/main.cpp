@@ -0,0 +1,95 @@
+// Renders the Map tab over a synthetic track, panning along it at each
+// zoom level, and reports the frame times. Exits with 1 if the average
+// frame at any zoom level is slower than the frame rate budget.
+//
+//   > mapbench [tile dir] [points] [min fps]
+//
+// defaults to no tiles, 100000 points and 20 fps.
+
+#include <QApplication>
+#include <QImage>
+#include <QVector>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "track.h"
+#include "mapview.h"
+
+#define PI 3.14159265358979
+#define FRAMES_PER_ZOOM 40
+
+static qint64 nsecs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (qint64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	QApplication app(argc, argv);
+	QString tile_dir= argc > 1 ? argv[1] : "";
+	int points= argc > 2 ? atoi(argv[2]) : 100000;
+	int min_fps= argc > 3 ? atoi(argv[3]) : 20;
+
+	// a walk at 1.4 m per fix that wanders about, like a long day out
+	QVector<double> lats(points), longs(points);
+	double lat= 49.28, longit= -123.12;
+	double heading= 0.0;
+	srand(1);
+	for(int i= 0; i < points; i++){
+		heading += ((rand() % 2001) - 1000) / 10000.0;
+		lat += 1.4 * cos(heading) / 111320.0;
+		longit += 1.4 * sin(heading) / (111320.0 * cos(lat * PI / 180.0));
+		lats[i]= lat;
+		longs[i]= longit;
+	}
+
+	Track track;
+	qint64 t= nsecs();
+	for(int i= 0; i < points; i++)
+		track.append(lats[i], longs[i]);
+	printf("built %d point track in %.1f ms\n", points, (nsecs() - t) / 1000000.0);
+
+	MapView view(&track, tile_dir);
+	view.resize(480, 640);
+	QImage frame(view.size(), QImage::Format_RGB16);
+
+	for(int i= 0; i < Track::MaxZoom; i++)
+		view.zoomOut();
+
+	int failures= 0;
+	printf("%4s %8s %8s %8s %6s\n", "zoom", "points", "avg ms", "max ms", "fps");
+	for(int zoom= Track::MinZoom; zoom <= Track::MaxZoom; zoom++){
+		qint64 total= 0, worst= 0;
+		for(int f= 0; f < FRAMES_PER_ZOOM; f++){
+			// pan along the track, the first frame at each zoom is the zoom itself
+			int i= (int)((qint64)f * (points - 1) / (FRAMES_PER_ZOOM - 1));
+			if(f > 0)
+				view.setPosition(lats[i], longs[i]);
+
+			// let any decoded tiles arrive, as they would between frames
+			app.processEvents();
+			t= nsecs();
+			view.render(&frame);
+			qint64 ns= nsecs() - t;
+			total += ns;
+			if(ns > worst)
+				worst= ns;
+		}
+
+		double avg= total / (double)FRAMES_PER_ZOOM / 1000000.0;
+		double fps= avg > 0.0 ? 1000.0 / avg : 0.0;
+		bool fail= fps < min_fps;
+		if(fail)
+			failures++;
+		printf("%4d %8d %8.2f %8.2f %6.1f%s\n", zoom, track.points(zoom).size(), avg, worst / 1000000.0, fps, fail ? "  FAIL" : "");
+		view.zoomIn();
+	}
+
+	printf("%d failures\n", failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+TEMPLATE=app
+TARGET=mapbench
+
+CONFIG+=qtopia
+DEFINES+=QT_NO_DEBUG_OUTPUT
+# clock_gettime
+LIBS+=-lrt
+
+INCLUDEPATH+=../..
+
+# Input files
+HEADERS=\
+    ../../track.h\
+    ../../tilecache.h\
+    ../../mapview.h
+
+SOURCES=\
+    main.cpp\
+    ../../track.cpp\
+    ../../tilecache.cpp\
+    ../../mapview.cpp
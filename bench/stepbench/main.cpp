@@ -0,0 +1,138 @@
+// Replays recorded accelerometer data through the step detector, in the
+// "<ms> <x> <y> <z>" mg format of the -accel option, and checks the step
+// count and cadence against the manifest. Exits with 1 if any recording
+// is outside its budgets.
+//
+//   > stepbench [manifest]
+//
+// defaults to recordings/manifest.txt. Each line of the manifest is...
+//
+//   <file> <rate Hz> <steps> <max step error> <cadence> <max cadence error>
+//
+// where the cadence is steps per minute, the average of what the
+// detector gives at each step once it has settled. The time budget for
+// the lines that follow is set by...
+//
+//   ns_per_sample <max ns>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stepdetector.h"
+
+// time each recording for at least this long so short ones give a steady figure
+#define MIN_BENCH_NS 200000000LL
+// a few times what a PC takes, raise it in the manifest for the phone
+#define DEFAULT_NS_PER_SAMPLE 300
+// steps before the cadence has filled its intervals
+#define SETTLE_STEPS 8
+
+struct Sample
+{
+	int ms;
+	int x, y, z;
+};
+
+static qint64 nsecs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (qint64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static bool load(const QString &path, QVector<Sample> &samples)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	char line[128];
+	Sample s;
+	while(file.readLine(line, sizeof(line)) > 0){
+		if(sscanf(line, "%d %d %d %d", &s.ms, &s.x, &s.y, &s.z) == 4)
+			samples.append(s);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QString manifest= argc > 1 ? argv[1] : "recordings/manifest.txt";
+
+	QFile file(manifest);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+		fprintf(stderr, "Cannot read manifest %s\n", (const char *)manifest.toAscii());
+		return 2;
+	}
+	QString dir= QFileInfo(manifest).absolutePath();
+
+	int failures= 0;
+	int max_ns= DEFAULT_NS_PER_SAMPLE;
+	printf("%-16s %4s %6s %6s %6s %6s %8s\n", "recording", "Hz", "steps", "true", "spm", "true", "ns each");
+
+	char line[256];
+	while(file.readLine(line, sizeof(line)) > 0){
+		char name[128];
+		int rate, true_steps, max_step_error, true_cadence, max_cadence_error;
+		if(line[0] == '#' || sscanf(line, "%127s", name) != 1)
+			continue;
+		if(sscanf(line, "ns_per_sample %d", &max_ns) == 1)
+			continue;
+		if(sscanf(line, "%127s %d %d %d %d %d", name, &rate, &true_steps, &max_step_error, &true_cadence, &max_cadence_error) != 6){
+			fprintf(stderr, "Bad manifest line: %s", line);
+			failures++;
+			continue;
+		}
+
+		QString path= dir + "/" + name;
+		QVector<Sample> samples;
+		if(!load(path, samples) || samples.isEmpty()){
+			fprintf(stderr, "Cannot read recording %s\n", (const char *)path.toAscii());
+			failures++;
+			continue;
+		}
+
+		StepDetector detector(rate);
+		const Sample *s= samples.constData();
+		int n= samples.size();
+
+		// the cadence is taken at each step, once it has settled
+		int cadence_sum= 0, cadence_n= 0;
+		for(int i= 0; i < n; i++){
+			if(detector.sample(s[i].ms, s[i].x, s[i].y, s[i].z) && detector.steps() > SETTLE_STEPS){
+				cadence_sum += detector.cadence();
+				cadence_n++;
+			}
+		}
+		int steps= detector.steps();
+
+		// then time it, repeating until the time is measurable
+		qint64 elapsed= 0;
+		qint64 count= 0;
+		do{
+			detector.reset();
+			qint64 t= nsecs();
+			for(int i= 0; i < n; i++)
+				detector.sample(s[i].ms, s[i].x, s[i].y, s[i].z);
+			elapsed += nsecs() - t;
+			count += n;
+		}while(elapsed < MIN_BENCH_NS);
+
+		int cadence= cadence_n > 0 ? cadence_sum / cadence_n : 0;
+		double ns= elapsed / (double)count;
+		bool fail= abs(steps - true_steps) > max_step_error || abs(cadence - true_cadence) > max_cadence_error || ns > max_ns;
+		if(fail)
+			failures++;
+		printf("%-16s %4d %6d %6d %6d %6d %8.1f%s\n", name, rate, steps, true_steps, cadence, true_cadence, ns, fail ? "  FAIL" : "");
+	}
+
+	printf("%d failures\n", failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+TEMPLATE=app
+TARGET=stepbench
+
+CONFIG+=qtopia
+DEFINES+=QT_NO_DEBUG_OUTPUT
+# clock_gettime
+LIBS+=-lrt
+
+INCLUDEPATH+=../..
+
+# Input files
+HEADERS=\
+    ../../stepdetector.h
+
+SOURCES=\
+    main.cpp\
+    ../../stepdetector.cpp
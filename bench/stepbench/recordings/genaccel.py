@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+# Generates the synthetic accelerometer recordings used by stepbench, in
+# the same "<ms> <x> <y> <z>" mg format the -accel replay reads, and
+# prints the true step count and cadence of each for the manifest.
+#
+# Walking is a bounce once a step along gravity with a sharper heel
+# strike harmonic, a sway from side to side once a stride, a few percent
+# of jitter in each step's length and sensor noise, with the phone at an
+# angle as it would be in a pocket. Each recording stands still before
+# and after the walk.
+
+import math
+import random
+
+
+def recording(name, rate, walk_secs, spm, still_secs, seed, bounce=250.0, tilt=(20.0, 35.0)):
+    rnd = random.Random(seed)
+    # gravity, and so the bounce, along a tilted axis
+    a, b = math.radians(tilt[0]), math.radians(tilt[1])
+    up = (math.sin(a) * math.cos(b), math.sin(a) * math.sin(b), math.cos(a))
+    side = (math.cos(b + math.pi / 2), math.sin(b + math.pi / 2), 0.0)
+
+    steps = 0
+    phase = 0.0
+    step_hz = spm / 60.0 * (1.0 + rnd.gauss(0, 0.03))
+    total = still_secs * 2 + walk_secs
+    with open(name, "w") as f:
+        for i in range(int(total * rate)):
+            t = i / float(rate)
+            vert = lat = 0.0
+            if still_secs <= t < still_secs + walk_secs:
+                phase += step_hz / rate
+                if phase >= 1.0:
+                    phase -= 1.0
+                    steps += 1
+                    step_hz = spm / 60.0 * (1.0 + rnd.gauss(0, 0.03))
+                p = 2 * math.pi * phase
+                vert = bounce * (math.sin(p) + 0.4 * math.sin(2 * p + 0.8))
+                lat = 0.3 * bounce * math.sin(p / 2 + math.pi * (steps % 2))
+            else:
+                # fidgeting while standing
+                vert = 15.0 * math.sin(2 * math.pi * 0.3 * t)
+            g = 1000.0 + vert
+            v = [g * up[k] + lat * side[k] + rnd.gauss(0, 25.0) for k in range(3)]
+            f.write("%d %d %d %d\n" % (int(round(t * 1000)), int(round(v[0])), int(round(v[1])), int(round(v[2]))))
+    print("%-16s %4d Hz %5d steps %4d spm" % (name, rate, steps, spm))
+
+
+recording("walk100.acc", 100, 60, 108, 10, 1)
+recording("walk50.acc", 50, 60, 108, 10, 2)
+recording("slow50.acc", 50, 60, 84, 10, 3, bounce=150.0)
+recording("brisk100.acc", 100, 60, 132, 10, 4, bounce=350.0, tilt=(70.0, 10.0))
+recording("still100.acc", 100, 0, 0, 30, 5)
@@ -0,0 +1,96 @@
+// Connects many clients to the telemetry server of a running
+// qtpedometer, one that never reads and one that keeps sending junk,
+// and checks that all but the stalled one still get an update at least
+// every few seconds. Exits with 1 if any of them fall behind or are
+// dropped.
+//
+//   > telemetryload <port> [clients] [seconds] [address]
+//
+// defaults to 100 clients for 30 seconds on 127.0.0.1.
+
+#include <QCoreApplication>
+#include <QTcpSocket>
+#include <QTime>
+#include <QVector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// the GPS gives a fix a second, allow for a few to be coalesced
+#define MAX_GAP_MS 5000
+#define JUNK_SIZE 4096
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	if(argc < 2){
+		fprintf(stderr, "usage: telemetryload <port> [clients] [seconds] [address]\n");
+		return 2;
+	}
+	int port= atoi(argv[1]);
+	int count= argc > 2 ? atoi(argv[2]) : 100;
+	int seconds= argc > 3 ? atoi(argv[3]) : 30;
+	QString address= argc > 4 ? argv[4] : "127.0.0.1";
+	if(count < 3)
+		count= 3;
+
+	// client 0 never reads, client 1 sends junk as fast as it can
+	QVector<QTcpSocket *> sockets(count);
+	QVector<int> lines(count, 0);
+	QVector<int> last(count, 0);
+	QVector<int> worst(count, 0);
+	for(int i= 0; i < count; i++){
+		sockets[i]= new QTcpSocket;
+		if(i == 0)
+			sockets[i]->setReadBufferSize(1);
+		sockets[i]->connectToHost(address, port);
+		if(!sockets[i]->waitForConnected(5000)){
+			fprintf(stderr, "client %d cannot connect: %s\n", i, (const char *)sockets[i]->errorString().toAscii());
+			return 1;
+		}
+	}
+	QByteArray junk(JUNK_SIZE, 'x');
+
+	QTime timer;
+	timer.start();
+	while(timer.elapsed() < seconds * 1000){
+		sockets[2]->waitForReadyRead(100);
+		app.processEvents();
+
+		if(sockets[1]->bytesToWrite() < JUNK_SIZE)
+			sockets[1]->write(junk);
+
+		int ms= timer.elapsed();
+		for(int i= 1; i < count; i++){
+			int n= sockets[i]->readAll().count('\n');
+			if(n > 0){
+				lines[i] += n;
+				last[i]= ms;
+			}
+			if(ms - last[i] > worst[i])
+				worst[i]= ms - last[i];
+		}
+	}
+
+	int failures= 0;
+	int min_lines= -1, max_gap= 0;
+	for(int i= 1; i < count; i++){
+		bool fail= sockets[i]->state() != QAbstractSocket::ConnectedState || worst[i] > MAX_GAP_MS;
+		if(fail){
+			fprintf(stderr, "client %d%s: %d updates, longest gap %d ms%s\n", i, i == 1 ? " (junk)" : "", lines[i], worst[i],
+					sockets[i]->state() != QAbstractSocket::ConnectedState ? ", dropped" : "");
+			failures++;
+		}
+		if(min_lines < 0 || lines[i] < min_lines)
+			min_lines= lines[i];
+		if(worst[i] > max_gap)
+			max_gap= worst[i];
+	}
+	printf("%d clients, %d s, fewest updates %d, longest gap %d ms, stalled client %s\n", count, seconds, min_lines, max_gap,
+		   sockets[0]->state() == QAbstractSocket::ConnectedState ? "still connected" : "dropped");
+	printf("%d failures\n", failures);
+
+	for(int i= 0; i < count; i++)
+		delete sockets[i];
+	return failures > 0 ? 1 : 0;
+}
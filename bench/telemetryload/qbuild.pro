@@ -0,0 +1,10 @@
+TEMPLATE=app
+TARGET=telemetryload
+
+CONFIG+=qtopia
+QT*=network
+DEFINES+=QT_NO_DEBUG_OUTPUT
+
+# Input files
+SOURCES=\
+    main.cpp
@@ -0,0 +1,19 @@
+// Replays the reference tracks listed in a manifest through the trip
+// distance calculation, see tripbench.h. Exits with 1 if any track is
+// outside its error, time or memory budget.
+//
+//   > tripbench [manifest]
+//
+// defaults to tracks/manifest.txt.
+
+#include <QCoreApplication>
+
+#include "tripbench.h"
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QString manifest= argc > 1 ? argv[1] : "tracks/manifest.txt";
+
+	return TripBench::run(manifest);
+}
@@ -0,0 +1,20 @@
+TEMPLATE=app
+TARGET=tripbench
+
+CONFIG+=qtopia
+QTOPIA*=whereabouts
+DEFINES+=QT_NO_DEBUG_OUTPUT
+# clock_gettime
+LIBS+=-lrt
+
+INCLUDEPATH+=../..
+
+# Input files
+HEADERS=\
+    tripbench.h\
+    ../../trip.h
+
+SOURCES=\
+    main.cpp\
+    tripbench.cpp\
+    ../../trip.cpp
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# Generates the synthetic reference tracks used by tripbench, as NMEA
+# $GPRMC sentences at 1Hz, with correlated position noise like a real
+# GPS, and prints the true distance of each for the manifest.
+#
+# A track is a list of legs of (seconds, speed m/s, degrees turned), the
+# heading turns at a steady rate through each leg, so a leg with a turn
+# is an arc and a short one is a street corner. The true distance is the
+# length of the path, not of the chords between fixes.
+
+import math
+import random
+
+R = 6371000.0
+START = (49.28, -123.12)
+STEPS = 10      # path points per second
+
+
+def offset(lat, lon, north, east):
+    return (lat + math.degrees(north / R),
+            lon + math.degrees(east / (R * math.cos(math.radians(lat)))))
+
+
+def nmea_pos(v, hemis, width):
+    h = hemis[0] if v >= 0 else hemis[1]
+    v = abs(v)
+    deg = int(v)
+    return "%0*d%08.5f,%s" % (width, deg, (v - deg) * 60.0, h)
+
+
+def rmc(t, pos, speed, course):
+    hh, mm, ss = 10 + t // 3600, (t // 60) % 60, t % 60
+    body = "GPRMC,%02d%02d%02d.00,A,%s,%s,%.2f,%.1f,010610,,,A" % (
+        hh, mm, ss, nmea_pos(pos[0], "NS", 2), nmea_pos(pos[1], "EW", 3),
+        speed / 0.514444, course % 360.0)
+    cs = 0
+    for c in body:
+        cs ^= ord(c)
+    return "$%s*%02X" % (body, cs)
+
+
+def path(legs, heading):
+    """true (north, east, speed, heading) once a second along the legs"""
+    north = east = 0.0
+    fixes = [(north, east, legs[0][1], heading)]
+    for secs, speed, turn in legs:
+        rate = turn / (secs * STEPS)
+        for i in range(secs * STEPS):
+            heading += rate
+            north += speed / STEPS * math.cos(math.radians(heading))
+            east += speed / STEPS * math.sin(math.radians(heading))
+            if (i + 1) % STEPS == 0:
+                fixes.append((north, east, speed, heading))
+    return fixes
+
+
+def track(name, legs, heading, noise, speed_noise, seed, multipath=None):
+    """multipath is (chance a second, (min, max) meters, (min, max) seconds)
+    of the fix jumping off to a reflection for a while"""
+    rnd = random.Random(seed)
+    fixes = path(legs, heading)
+    truth = sum(secs * speed for secs, speed, turn in legs)
+    # AR(1) noise with the given standard deviation, about 10 s correlation
+    a = 0.9
+    e = noise * math.sqrt(1 - a * a)
+    nn = ne = 0.0
+    jump = (0.0, 0.0)
+    jump_left = 0
+    with open(name, "w") as f:
+        for t, (north, east, speed, course) in enumerate(fixes):
+            nn = a * nn + rnd.gauss(0, e)
+            ne = a * ne + rnd.gauss(0, e)
+            if jump_left > 0:
+                jump_left -= 1
+                if jump_left == 0:
+                    jump = (0.0, 0.0)
+            elif multipath and rnd.random() < multipath[0]:
+                d = rnd.uniform(*multipath[1])
+                b = rnd.uniform(0, 2 * math.pi)
+                jump = (d * math.cos(b), d * math.sin(b))
+                jump_left = rnd.randint(*multipath[2])
+            pos = offset(START[0], START[1], north + nn + jump[0], east + ne + jump[1])
+            # the reported speed is noisy and never negative
+            s = abs(speed + rnd.gauss(0, speed_noise))
+            f.write(rmc(t, pos, s, course) + "\r\n")
+    print("%-16s %10.1f" % (name, truth))
+
+
+def city(rnd, speed, blocks):
+    """straight blocks with a corner at the end of each, left or right"""
+    legs = []
+    for i in range(blocks):
+        legs.append((rnd.randint(60, 100), speed, 0.0))
+        legs.append((5, speed, rnd.choice((-90.0, 90.0))))
+    return legs
+
+
+def winding(rnd, speed, bends):
+    """a road of bends of 30 to 120 degrees either way"""
+    legs = []
+    for i in range(bends):
+        legs.append((rnd.randint(10, 40), speed, 0.0))
+        legs.append((rnd.randint(10, 30), speed, rnd.choice((-1, 1)) * rnd.uniform(30.0, 120.0)))
+    return legs
+
+
+rnd = random.Random(10)
+
+# 2 mile walk round town at 1.4 m/s, and once round a 40 m park loop
+walk = city(rnd, 1.4, 12)
+walk[12:12] = [(180, 1.4, 360.0)]
+walk.append((int(round((3218.7 - sum(s * v for s, v, t in walk)) / 1.4)), 1.4, 0.0))
+track("walk.nmea", walk, 90.0, 2.5, 0.15, 1)
+
+# half an hour cycling a winding road at 5 m/s
+track("cycle.nmea", winding(rnd, 5.0, 40), 0.0, 2.5, 0.15, 4)
+
+# 10 minute drive at 15 m/s, with gentle bends and slow turns at junctions
+drive = [(120, 15.0, 0.0), (60, 15.0, 40.0), (8, 6.0, 90.0), (150, 15.0, -25.0),
+         (8, 6.0, -90.0), (100, 15.0, 0.0), (90, 15.0, -60.0), (64, 15.0, 0.0)]
+track("drive.nmea", drive, 45.0, 2.5, 0.15, 2)
+
+# 20 minutes walking between tall buildings, the fix is worse and now
+# and then jumps off to a reflection for a few seconds
+track("canyon.nmea", city(rnd, 1.4, 14), 0.0, 6.0, 0.4, 5, (0.02, (15.0, 40.0), (5, 20)))
+
+# sitting still
+track("stationary.nmea", [(599, 0.0, 0.0)], 0.0, 3.0, 0.2, 3)
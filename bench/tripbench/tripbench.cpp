@@ -0,0 +1,164 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QList>
+#include <QStringList>
+#include <QTextStream>
+#include <QWhereaboutsUpdate>
+
+#include <malloc.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "tripbench.h"
+#include "trip.h"
+
+// time each track for at least this long so short tracks give a steady figure
+#define MIN_BENCH_NS 200000000LL
+
+// budgets used until the manifest sets its own, a few times what a PC
+// takes, the trip keeps nothing but the last fixes
+#define DEFAULT_NS_PER_FIX 500
+#define DEFAULT_MEMORY_KB 2
+
+static const int all_sensitivities[]= { 0, 10, 20, 30, 50 };
+
+static qint64 nsecs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (qint64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// bytes allocated on the heap right now, mallinfo() is deprecated from
+// glibc 2.33 as its counts can overflow
+static qint64 heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 mi= mallinfo2();
+#else
+	struct mallinfo mi= mallinfo();
+#endif
+	return (qint64)mi.uordblks + mi.hblkhd;
+}
+
+// only RMC sentences are used, they have the position, speed and time
+// the trip needs, once per fix
+static bool loadTrack(const QString &fn, QList<QWhereaboutsUpdate> &fixes)
+{
+	QFile file(fn);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	while(!file.atEnd()){
+		QByteArray line= file.readLine().trimmed();
+		if(!line.startsWith("$GPRMC"))
+			continue;
+		QWhereaboutsUpdate update= QWhereaboutsUpdate::fromNmea(line);
+		if(update.coordinate().type() != QWhereaboutsCoordinate::InvalidCoordinate)
+			fixes.append(update);
+	}
+	return true;
+}
+
+int TripBench::run(const QString &manifest)
+{
+	QFile file(manifest);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+		fprintf(stderr, "Cannot read manifest %s\n", (const char *)manifest.toAscii());
+		return 2;
+	}
+	QDir dir= QFileInfo(manifest).absoluteDir();
+
+	int failures= 0;
+	int max_ns_per_fix= DEFAULT_NS_PER_FIX;
+	int max_memory_kb= DEFAULT_MEMORY_KB;
+	printf("%-24s %6s %10s %10s %8s %8s %8s\n", "track", "sens", "truth m", "trip m", "error", "ns/fix", "KB");
+
+	QTextStream in(&file);
+	QString line;
+	while(!(line= in.readLine()).isNull()){
+		line= line.trimmed();
+		if(line.isEmpty() || line.startsWith("#"))
+			continue;
+
+		QStringList f= line.split(QRegExp("\\s+"));
+		if(f.size() == 2 && f.at(0) == "ns_per_fix"){
+			max_ns_per_fix= f.at(1).toInt();
+			continue;
+		}
+		if(f.size() == 2 && f.at(0) == "memory_kb"){
+			max_memory_kb= f.at(1).toInt();
+			continue;
+		}
+		if(f.size() < 4){
+			fprintf(stderr, "Bad manifest line: %s\n", (const char *)line.toAscii());
+			failures++;
+			continue;
+		}
+
+		QString fn= dir.filePath(f.at(0));
+		qreal truth= f.at(1).toDouble();
+		bool percent= f.at(3).endsWith("%");
+		qreal budget= QString(f.at(3)).remove(QRegExp("[%m]$")).toDouble();
+
+		QList<QWhereaboutsUpdate> fixes;
+		if(!loadTrack(fn, fixes) || fixes.isEmpty()){
+			fprintf(stderr, "Cannot read track %s\n", (const char *)fn.toAscii());
+			failures++;
+			continue;
+		}
+
+		QList<int> sensitivities;
+		if(f.at(2) == "all"){
+			for(unsigned i= 0; i < sizeof(all_sensitivities) / sizeof(all_sensitivities[0]); i++)
+				sensitivities.append(all_sensitivities[i]);
+		}else
+			sensitivities.append(f.at(2).toInt());
+
+		foreach(int sens, sensitivities){
+			// the trip and whatever it keeps on the heap once the track
+			// has been replayed, the fixes themselves are loaded already
+			qint64 heap= heapInUse();
+			Trip *trip= new Trip;
+			trip->setSensitivity(sens);
+
+			// the first pass gives the distance, repeat until the time is measurable
+			qint64 elapsed= 0;
+			qint64 count= 0;
+			qreal dist= 0.0;
+			do{
+				trip->reset();
+				qint64 t= nsecs();
+				for(int i= 0; i < fixes.size(); i++)
+					trip->update(fixes.at(i));
+				elapsed += nsecs() - t;
+				if(count == 0)
+					dist= trip->distance();
+				count += fixes.size();
+			}while(elapsed < MIN_BENCH_NS);
+			int kb= (int)((heapInUse() - heap + 1023) / 1024);
+			if(kb < 0)
+				kb= 0;
+			delete trip;
+
+			qreal error= dist - truth;
+			if(error < 0.0)
+				error= -error;
+			if(percent)
+				error= truth > 0.0 ? error * 100.0 / truth : 0.0;
+			int ns= (int)(elapsed / count);
+
+			bool fail= error > budget || ns > max_ns_per_fix || kb > max_memory_kb;
+			if(fail)
+				failures++;
+
+			printf("%-24s %6d %10.1f %10.1f %7.2f%s %8d %8d%s\n", (const char *)f.at(0).toAscii(), sens, truth, dist,
+				   error, percent ? "%" : "m", ns, kb, fail ? "  FAIL" : "");
+		}
+	}
+
+	printf("%d failures\n", failures);
+	fflush(stdout);
+	return failures > 0 ? 1 : 0;
+}
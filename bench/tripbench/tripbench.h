@@ -0,0 +1,26 @@
+#ifndef TRIPBENCH_H
+#define TRIPBENCH_H
+
+#include <QString>
+
+// Replays reference NMEA tracks through Trip under each accumulation
+// setting, reporting distance error against ground truth, ns per fix
+// and memory used. Returns non zero if any budget is exceeded.
+//
+// Each line of the manifest is...
+//
+//   <nmea file> <true distance m> <sensitivity m|all> <max error>[%|m]
+//
+// where a sensitivity of 0 is the GPS speed method and all runs the
+// speed method and each of the sensitivities in the settings range.
+// The time and memory budgets for the lines that follow are set by...
+//
+//   ns_per_fix <max ns>
+//   memory_kb <max KB>
+class TripBench
+{
+ public:
+	static int run(const QString &manifest);
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <QFile>
+#include <QtDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <stddef.h>
+
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC 0x50454431	// "PED1"
+
+Checkpoint::Checkpoint(const QString &path, bool use_journal)
+{
+	sequence= 0;
+	fd= ::open(QFile::encodeName(path), O_RDWR | O_CREAT, 0644);
+	if(fd < 0)
+		qDebug("Cannot open checkpoint %s", (const char *)path.toAscii());
+
+	journal_fd= -1;
+	if(use_journal){
+		journal_fd= ::open(QFile::encodeName(path + ".journal"), O_RDWR | O_CREAT | O_APPEND, 0644);
+		if(journal_fd < 0)
+			qDebug("Cannot open checkpoint journal %s.journal", (const char *)path.toAscii());
+	}
+}
+
+Checkpoint::~Checkpoint()
+{
+	if(fd >= 0)
+		::close(fd);
+	if(journal_fd >= 0)
+		::close(journal_fd);
+}
+
+qint64 Checkpoint::now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (qint64)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// simple Fletcher sum over everything before the checksum
+quint32 Checkpoint::checksum(const Record &record)
+{
+	const quint16 *p= (const quint16 *)&record;
+	int n= offsetof(Record, checksum) / 2;
+	quint32 a= 0xffff, b= 0xffff;
+	for(int i= 0; i < n; i++){
+		a= (a + p[i]) % 65535;
+		b= (b + a) % 65535;
+	}
+	return (b << 16) | a;
+}
+
+bool Checkpoint::valid(const Record &record) const
+{
+	return record.magic == CHECKPOINT_MAGIC && record.checksum == checksum(record);
+}
+
+bool Checkpoint::load(Record &record)
+{
+	if(fd < 0)
+		return false;
+
+	Record slots[2];
+	bool good[2];
+	for(int i= 0; i < 2; i++)
+		good[i]= pread(fd, &slots[i], sizeof(Record), i * sizeof(Record)) == sizeof(Record) && valid(slots[i]);
+
+	int newest;
+	if(good[0] && good[1])
+		newest= slots[1].sequence > slots[0].sequence ? 1 : 0;
+	else if(good[0] || good[1])
+		newest= good[0] ? 0 : 1;
+	else
+		return false;
+
+	record= slots[newest];
+	sequence= record.sequence;
+
+	// the last whole journal entry written after that checkpoint, if any
+	if(journal_fd >= 0){
+		off_t size= lseek(journal_fd, 0, SEEK_END);
+		off_t last= (size / (off_t)sizeof(Record) - 1) * (off_t)sizeof(Record);
+		Record entry;
+		if(last >= 0 && pread(journal_fd, &entry, sizeof(Record), last) == sizeof(Record)
+		   && valid(entry) && entry.sequence == record.sequence && entry.elapsed_ms >= record.elapsed_ms){
+			entry.state= record.state;
+			record= entry;
+		}
+	}
+	return true;
+}
+
+// writes the slot not holding the newest checkpoint, so a crash part way
+// through leaves the other one alone, then starts the journal again
+void Checkpoint::write(Record &record)
+{
+	if(fd < 0)
+		return;
+
+	record.magic= CHECKPOINT_MAGIC;
+	record.sequence= ++sequence;
+	record.reserved= 0;
+	record.checksum= checksum(record);
+	off_t slot= (record.sequence % 2) * sizeof(Record);
+	if(pwrite(fd, &record, sizeof(Record), slot) != sizeof(Record)){
+		qDebug("checkpoint write failed");
+		return;
+	}
+	fdatasync(fd);
+
+	if(journal_fd >= 0 && ftruncate(journal_fd, 0) != 0)
+		qDebug("checkpoint journal truncate failed");
+}
+
+void Checkpoint::journal(Record &record)
+{
+	if(journal_fd < 0)
+		return;
+
+	record.magic= CHECKPOINT_MAGIC;
+	record.sequence= sequence;
+	record.reserved= 0;
+	record.checksum= checksum(record);
+	if(::write(journal_fd, &record, sizeof(Record)) != sizeof(Record))
+		qDebug("checkpoint journal write failed");
+}
@@ -0,0 +1,48 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QString>
+
+// Keeps the trip state on disk so a trip survives the app being killed,
+// a flat battery or a reboot. The checkpoint file holds two fixed size
+// slots written alternately and synced, so one of them is always whole.
+// Between checkpoints each fix can be appended to a journal, which is
+// not synced, it survives the app dying but maybe not the power going.
+class Checkpoint
+{
+ public:
+	enum State { Stopped= 0, Running= 1, Paused= 2 };
+
+	struct Record
+	{
+		quint32 magic;
+		quint32 sequence;
+		qint32 state;
+		qint32 steps;
+		qint64 saved_at;	// wall clock, ms since the epoch
+		qint64 elapsed_ms;	// trip time
+		double distance;	// meters
+		quint32 reserved;
+		quint32 checksum;
+	};
+
+	Checkpoint(const QString &path, bool use_journal);
+	~Checkpoint();
+
+	// the most recent state, from the newest good slot and any journal after it
+	bool load(Record &record);
+	void write(Record &record);
+	void journal(Record &record);
+
+	static qint64 now();
+
+ private:
+	static quint32 checksum(const Record &record);
+	bool valid(const Record &record) const;
+
+	int fd;
+	int journal_fd;
+	quint32 sequence;
+};
+
+#endif
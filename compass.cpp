@@ -7,6 +7,8 @@ Compass::Compass(QWidget *parent) : QWidget(parent)
 	bearing= 0.0;
 	azimuth= 0.0;
 	show_azimuth= false;
+	ghost= 0.0;
+	show_ghost= false;
 }
 
 void Compass::setBearing(qreal pt)
@@ -27,6 +29,19 @@ void Compass::showAzimuth(bool flg)
 	update();
 }
 
+// direction to where the trip being raced was at this time
+void Compass::setGhost(qreal pt)
+{
+	ghost= pt;
+	update();
+}
+
+void Compass::showGhost(bool flg)
+{
+	show_ghost= flg;
+	update();
+}
+
 void Compass::paintEvent(QPaintEvent *)
 {
 	//qDebug("In compass paint");
@@ -46,6 +61,11 @@ void Compass::paintEvent(QPaintEvent *)
 		QPoint(-7, 0),
 		QPoint(0, -70)
 	};
+	static const QPoint ghostPointer[3] = {
+		QPoint(6, 0),
+		QPoint(-6, 0),
+		QPoint(0, -55)
+	};
 
 	// A nice vector arrow found online
 	static const QPoint directionPointer[12] = {
@@ -66,6 +86,7 @@ void Compass::paintEvent(QPaintEvent *)
 	QColor northColor(Qt::white);
 	QColor southColor(127, 0, 0);
 	QColor azimuthColor(Qt::green);
+	QColor ghostColor(255, 165, 0);
 
 	int side = qMin(width(), height());
 
@@ -111,6 +132,16 @@ void Compass::paintEvent(QPaintEvent *)
 		painter.restore();
 	}
 
+	// Draw race ghost pointer
+	if(show_ghost){
+		painter.setPen(Qt::NoPen);
+		painter.setBrush(ghostColor);
+		painter.save();
+		painter.rotate(ghost);
+		painter.drawConvexPolygon(ghostPointer, 3);
+		painter.restore();
+	}
+
 	// Draw Labels N, E, S, W
 	static const QString labels[4]={
 		QString("N"),
@@ -12,6 +12,8 @@ class Compass : public QWidget
 	void setBearing(qreal);
     void setAzimuth(qreal);
     void showAzimuth(bool);
+	void setGhost(qreal);
+	void showGhost(bool);
 
  protected:
 	void paintEvent(QPaintEvent *event);
@@ -20,6 +22,8 @@ class Compass : public QWidget
 	qreal bearing;
 	qreal azimuth;
 	bool show_azimuth;
+	qreal ghost;
+	bool show_ghost;
 };
 
 #endif
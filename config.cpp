@@ -0,0 +1,66 @@
+#include <QtDebug>
+#include <QDir>
+
+#include "config.h"
+
+Config::Config() : settings("e4Networks", "Pedometer")
+{
+	use_metric= false;
+	speed_threshold= 0.18;
+	distance_sensitivity= 30;
+	waypoint_lat= 0.0;
+	waypoint_long= 0.0;
+	tile_dir= "/media/card/tiles";
+	accel_device= "/dev/input/event3";
+	accel_rate= 100;
+	stride_mm= 750;
+	race_file= "/media/card/race.trk";
+	checkpoint_file= QDir::homePath() + "/.pedometer-trip";
+	checkpoint_interval= 30;
+	checkpoint_journal= true;
+	dem_replace= true;
+	telemetry_port= 0;
+	telemetry_address= "127.0.0.1";
+}
+
+void Config::load()
+{
+	use_metric= settings.value("metric", false).toBool();
+	speed_threshold= settings.value("threshold", 0.18).toDouble(); // M/S
+	distance_sensitivity= settings.value("sensitivity", 30).toInt(); // Meters
+	waypoint_lat= settings.value("waypoint/lat").toDouble();
+	waypoint_long= settings.value("waypoint/long").toDouble();
+	tile_dir= settings.value("map/tiles", tile_dir).toString();
+	accel_device= settings.value("accel/device", accel_device).toString();
+	accel_rate= settings.value("accel/rate", accel_rate).toInt();
+	stride_mm= settings.value("stride", stride_mm).toInt();
+	race_file= settings.value("race/file", race_file).toString();
+	checkpoint_file= settings.value("checkpoint/file", checkpoint_file).toString();
+	checkpoint_interval= settings.value("checkpoint/interval", checkpoint_interval).toInt();
+	checkpoint_journal= settings.value("checkpoint/journal", checkpoint_journal).toBool();
+	dem_dir= settings.value("dem/dir", dem_dir).toString();
+	dem_replace= settings.value("dem/replace", dem_replace).toBool();
+	telemetry_port= settings.value("telemetry/port", telemetry_port).toInt();
+	telemetry_address= settings.value("telemetry/address", telemetry_address).toString();
+	qDebug("speed_threshold= %6.2f m/s, distance_sensitivity= %d m", speed_threshold, distance_sensitivity);
+}
+
+void Config::saveSettings()
+{
+	settings.setValue("metric", use_metric);
+	settings.setValue("sensitivity", distance_sensitivity);
+}
+
+void Config::saveWayPoint(double lat, double longit)
+{
+	waypoint_lat= lat;
+	waypoint_long= longit;
+	settings.setValue("waypoint/lat", lat);
+	settings.setValue("waypoint/long", longit);
+}
+
+void Config::saveStride(int mm)
+{
+	stride_mm= mm;
+	settings.setValue("stride", mm);
+}
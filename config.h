@@ -0,0 +1,39 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <QSettings>
+
+// In memory copy of the persistent settings, loaded once at startup,
+// changes are written back through the one QSettings instance
+class Config
+{
+ public:
+	Config();
+	void load();
+	void saveSettings();
+	void saveWayPoint(double lat, double longit);
+	void saveStride(int mm);
+
+	bool use_metric;
+	double speed_threshold;		// M/S
+	int distance_sensitivity;	// Meters
+	double waypoint_lat;
+	double waypoint_long;
+	QString tile_dir;			// map tiles as <dir>/<zoom>/<x>/<y>.png
+	QString accel_device;		// accelerometer input event device
+	int accel_rate;				// Hz the device delivers, only picks the filters
+	int stride_mm;				// calibrated stride length
+	QString race_file;			// the saved trip that can be raced against
+	QString checkpoint_file;	// trip state kept here to survive a restart
+	int checkpoint_interval;	// seconds
+	bool checkpoint_journal;	// also journal every fix in between
+	QString dem_dir;			// SRTM .hgt tiles, empty for none
+	bool dem_replace;			// use terrain height for every fix, not just 2D ones
+	int telemetry_port;			// 0 is no telemetry server
+	QString telemetry_address;
+
+ private:
+	QSettings settings;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include <QtGui>
+
+#include <math.h>
+
+#include "mapview.h"
+
+#define TILE_SIZE 256
+// memory allowed for decoded tiles, about 64 RGB16 tiles
+#define TILE_CACHE_KBYTES 8192
+
+MapView::MapView(const Track *trk, const QString &tile_dir, QWidget *parent) : QWidget(parent)
+{
+	track= trk;
+	tiles= new TileCache(tile_dir, TILE_CACHE_KBYTES, this);
+	connect(tiles, SIGNAL(tileReady()), this, SLOT(update()));
+
+	zoom= 15;
+	center.x= 0.5;
+	center.y= 0.5;
+	position= center;
+	way_point= center;
+	have_position= false;
+	show_way_point= false;
+	follow= true;
+	setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void MapView::setPosition(double lat, double longit)
+{
+	position= Track::project(lat, longit);
+	have_position= true;
+	if(follow)
+		center= position;
+	update();
+}
+
+void MapView::setWayPoint(double lat, double longit)
+{
+	way_point= Track::project(lat, longit);
+	update();
+}
+
+void MapView::showWayPoint(bool flg)
+{
+	show_way_point= flg;
+	update();
+}
+
+void MapView::zoomIn()
+{
+	if(zoom < Track::MaxZoom){
+		zoom++;
+		update();
+	}
+}
+
+void MapView::zoomOut()
+{
+	if(zoom > Track::MinZoom){
+		zoom--;
+		update();
+	}
+}
+
+void MapView::setFollow(bool flg)
+{
+	follow= flg;
+	if(follow && have_position)
+		center= position;
+	update();
+}
+
+double MapView::worldSize() const
+{
+	return (double)TILE_SIZE * (1 << zoom);
+}
+
+QPointF MapView::toScreen(const TrackPoint &pt, double left, double top) const
+{
+	double w= worldSize();
+	return QPointF(pt.x * w - left, pt.y * w - top);
+}
+
+void MapView::mousePressEvent(QMouseEvent *event)
+{
+	drag_pos= event->pos();
+}
+
+// drag to pan, this stops following the current position
+void MapView::mouseMoveEvent(QMouseEvent *event)
+{
+	QPoint d= event->pos() - drag_pos;
+	drag_pos= event->pos();
+	double w= worldSize();
+	center.x= qBound(0.0, center.x - d.x() / w, 1.0);
+	center.y= qBound(0.0, center.y - d.y() / w, 1.0);
+	if(follow){
+		follow= false;
+		emit followChanged(false);
+	}
+	update();
+}
+
+void MapView::paintEvent(QPaintEvent *)
+{
+	QPainter painter(this);
+
+	// top left of the view in world pixels at this zoom level
+	double w= worldSize();
+	double left= floor(center.x * w - width() / 2);
+	double top= floor(center.y * w - height() / 2);
+
+	drawTiles(painter, left, top);
+	drawTrack(painter, left, top);
+
+	painter.setRenderHint(QPainter::Antialiasing);
+	if(show_way_point){
+		QPointF p= toScreen(way_point, left, top);
+		painter.setPen(Qt::black);
+		painter.setBrush(Qt::green);
+		painter.drawEllipse(QRectF(p.x() - 5, p.y() - 5, 10, 10));
+	}
+
+	if(have_position){
+		QPointF p= toScreen(position, left, top);
+		painter.setPen(Qt::white);
+		painter.setBrush(Qt::blue);
+		painter.drawEllipse(QRectF(p.x() - 6, p.y() - 6, 12, 12));
+	}
+}
+
+void MapView::drawTiles(QPainter &painter, double left, double top)
+{
+	int n= 1 << zoom;
+	int tx0= (int)floor(left / TILE_SIZE);
+	int ty0= (int)floor(top / TILE_SIZE);
+	int tx1= (int)floor((left + width()) / TILE_SIZE);
+	int ty1= (int)floor((top + height()) / TILE_SIZE);
+
+	for(int ty= ty0; ty <= ty1; ty++){
+		for(int tx= tx0; tx <= tx1; tx++){
+			QRectF target(tx * TILE_SIZE - left, ty * TILE_SIZE - top, TILE_SIZE, TILE_SIZE);
+			if(ty < 0 || ty >= n || tx < 0 || tx >= n){
+				painter.fillRect(target, Qt::darkGray);
+				continue;
+			}
+
+			const QImage *image= tiles->tile(zoom, tx, ty);
+			if(image != NULL && !image->isNull()){
+				painter.drawImage(target.topLeft(), *image);
+				continue;
+			}
+
+			// until it is loaded, stretch the quarter of the parent tile if we have it
+			const QImage *parent= zoom > 0 ? tiles->cached(zoom - 1, tx / 2, ty / 2) : NULL;
+			if(parent != NULL && !parent->isNull()){
+				int half= TILE_SIZE / 2;
+				QRectF source((tx % 2) * half, (ty % 2) * half, half, half);
+				painter.drawImage(target, *parent, source);
+			}else
+				painter.fillRect(target, Qt::lightGray);
+		}
+	}
+}
+
+// draws the track simplified for this zoom level, skipping the chunks
+// that are outside the view, so the cost depends on what is visible
+void MapView::drawTrack(QPainter &painter, double left, double top)
+{
+	const QVector<TrackPoint> &pts= track->points(zoom);
+	const QVector<TrackBounds> &chunks= track->chunks(zoom);
+	int n= pts.size();
+	if(n < 2)
+		return;
+
+	double w= worldSize();
+	double vx0= left / w;
+	double vy0= top / w;
+	double vx1= (left + width()) / w;
+	double vy1= (top + height()) / w;
+
+	QPen pen(Qt::red);
+	pen.setWidth(3);
+	painter.setPen(pen);
+
+	QPolygonF line;
+	for(int i= 0; i < chunks.size(); i++){
+		const TrackBounds &b= chunks.at(i);
+		if(b.x1 < vx0 || b.x0 > vx1 || b.y1 < vy0 || b.y0 > vy1){
+			if(line.size() > 1)
+				painter.drawPolyline(line);
+			line.clear();
+			continue;
+		}
+
+		// start from the last point of the previous chunk to join them up
+		int start= i * Track::ChunkSize;
+		if(line.isEmpty() && start > 0)
+			start--;
+		int end= qMin(n, (i + 1) * Track::ChunkSize);
+		for(int j= start; j < end; j++)
+			line.append(toScreen(pts.at(j), left, top));
+	}
+	if(line.size() > 1)
+		painter.drawPolyline(line);
+}
@@ -0,0 +1,51 @@
+#ifndef MAPVIEW_H
+#define MAPVIEW_H
+
+#include <QWidget>
+#include <QPoint>
+
+#include "track.h"
+#include "tilecache.h"
+
+class MapView : public QWidget
+{
+	Q_OBJECT
+
+ public:
+	MapView(const Track *track, const QString &tile_dir, QWidget *parent = 0);
+	void setPosition(double lat, double longit);
+	void setWayPoint(double lat, double longit);
+	void showWayPoint(bool);
+
+ signals:
+	void followChanged(bool);
+
+ public slots:
+	void zoomIn();
+	void zoomOut();
+	void setFollow(bool);
+
+ protected:
+	void paintEvent(QPaintEvent *event);
+	void mousePressEvent(QMouseEvent *event);
+	void mouseMoveEvent(QMouseEvent *event);
+
+ private:
+	void drawTiles(QPainter &painter, double left, double top);
+	void drawTrack(QPainter &painter, double left, double top);
+	QPointF toScreen(const TrackPoint &pt, double left, double top) const;
+	double worldSize() const;
+
+	const Track *track;
+	TileCache *tiles;
+	int zoom;
+	TrackPoint center;
+	TrackPoint position;
+	TrackPoint way_point;
+	bool have_position;
+	bool show_way_point;
+	bool follow;
+	QPoint drag_pos;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "profile.h"
+
+Profile::Profile()
+{
+	for(int i= 0; i < Levels; i++)
+		levels[i].ring.resize(Capacity);
+	clear();
+}
+
+void Profile::clear()
+{
+	for(int i= 0; i < Levels; i++){
+		levels[i].first= 0;
+		levels[i].used= 0;
+	}
+	samples= 0;
+	start_ms= end_ms= 0;
+	min_value= max_value= 0.0;
+}
+
+void Profile::append(int ms, float value)
+{
+	if(samples == 0){
+		start_ms= ms;
+		min_value= max_value= value;
+	}else{
+		if(value < min_value) min_value= value;
+		if(value > max_value) max_value= value;
+	}
+	end_ms= ms;
+	samples++;
+
+	for(int i= 0; i < Levels; i++)
+		add(levels[i], ms / bucketWidth(i), value);
+}
+
+static void startBucket(ProfileBucket &b)
+{
+	b.count= 0;
+	b.sum= 0.0;
+	b.min= b.max= 0.0;
+}
+
+// add the value to bucket n, starting new buckets up to it and
+// dropping the oldest when the level is full
+void Profile::add(Level &level, int n, float value)
+{
+	if(level.used == 0){
+		level.first= n;
+		level.used= 1;
+		startBucket(level.ring[n % Capacity]);
+	}else{
+		int last= level.first + level.used - 1;
+		if(n - last >= Capacity){
+			// a gap longer than the whole level
+			for(int i= 0; i < Capacity; i++)
+				startBucket(level.ring[i]);
+			level.first= n - Capacity + 1;
+			level.used= Capacity;
+		}else{
+			for(int i= last + 1; i <= n; i++){
+				if(level.used == Capacity)
+					level.first++;
+				else
+					level.used++;
+				startBucket(level.ring[i % Capacity]);
+			}
+		}
+	}
+
+	ProfileBucket &b= level.ring[n % Capacity];
+	if(n < level.first)
+		return; // older than anything kept, time went backwards
+
+	if(b.count == 0){
+		b.min= b.max= value;
+	}else{
+		if(value < b.min) b.min= value;
+		if(value > b.max) b.max= value;
+	}
+	b.sum += value;
+	b.count++;
+}
+
+int Profile::bestLevel() const
+{
+	for(int i= 0; i < Levels; i++){
+		if(levels[i].first <= start_ms / bucketWidth(i))
+			return i;
+	}
+	return Levels - 1;
+}
+
+const ProfileBucket &Profile::bucket(int level, int n) const
+{
+	return levels[level].ring.at(n % Capacity);
+}
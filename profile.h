@@ -0,0 +1,58 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <QVector>
+
+struct ProfileBucket
+{
+	float min;
+	float max;
+	float sum;
+	int count;
+};
+
+// A time series kept as min/max/sum buckets at several resolutions, each
+// resolution holds at most Capacity buckets, so memory is fixed however
+// long the trip is and drawing never has to look at individual samples
+class Profile
+{
+ public:
+	enum { Levels= 6, Capacity= 1024, BaseWidth= 1000 };	// BaseWidth in ms, each level is 4x wider
+
+	Profile();
+	void clear();
+	void append(int ms, float value);
+	bool isEmpty() const { return samples == 0; }
+
+	// the finest level that still holds everything since start, or the coarsest
+	int bestLevel() const;
+	int bucketWidth(int level) const { return BaseWidth << (2 * level); }
+	// number of the first bucket kept and how many follow it
+	int firstBucket(int level) const { return levels[level].first; }
+	int bucketCount(int level) const { return levels[level].used; }
+	const ProfileBucket &bucket(int level, int n) const;
+
+	int startTime() const { return start_ms; }
+	int endTime() const { return end_ms; }
+	float minimum() const { return min_value; }
+	float maximum() const { return max_value; }
+
+ private:
+	struct Level
+	{
+		QVector<ProfileBucket> ring;
+		int first;
+		int used;
+	};
+
+	void add(Level &level, int n, float value);
+
+	Level levels[Levels];
+	int samples;
+	int start_ms;
+	int end_ms;
+	float min_value;
+	float max_value;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include <QtGui>
+
+#include "profileview.h"
+
+#define METERS_TO_FEET 3.2808399            /* Meters to U.S./British feet */
+#define MPS_TO_MPH 2.2369363                /* Meters/second to miles per hour */
+
+ProfileView::ProfileView(const Profile *alt, const Profile *spd, QWidget *parent) : QWidget(parent)
+{
+	altitude= alt;
+	speed= spd;
+	use_metric= false;
+	setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void ProfileView::setMetric(bool flg)
+{
+	use_metric= flg;
+	update();
+}
+
+void ProfileView::paintEvent(QPaintEvent *)
+{
+	QPainter painter(this);
+	painter.fillRect(rect(), Qt::black);
+
+	// altitude on top, speed underneath
+	int h= height() / 2;
+	QRect top(0, 0, width(), h - 2);
+	QRect bottom(0, h + 2, width(), height() - h - 2);
+
+	painter.setFont(QFont("Times", 6));
+	drawProfile(painter, altitude, top, Qt::green, use_metric ? 1.0 : METERS_TO_FEET, use_metric ? " m" : " ft");
+	drawProfile(painter, speed, bottom, Qt::yellow, use_metric ? 1.0 : MPS_TO_MPH, use_metric ? " m/s" : " mph");
+}
+
+// Draws the min/max envelope and the average line, one column per pixel,
+// from the finest level of buckets that covers the whole trip. The cost is
+// bounded by the number of buckets in a level and the width, not the
+// number of fixes.
+void ProfileView::drawProfile(QPainter &painter, const Profile *profile, const QRect &area, const QColor &color, float scale, const QString &units)
+{
+	painter.setPen(Qt::darkGray);
+	painter.drawRect(area.adjusted(0, 0, -1, -1));
+	if(profile->isEmpty() || area.width() < 2)
+		return;
+
+	int level= profile->bestLevel();
+	int first= profile->firstBucket(level);
+	int count= profile->bucketCount(level);
+	int bw= profile->bucketWidth(level);
+	double span= qMax((double)count * bw, 1.0);
+
+	float lo= profile->minimum();
+	float hi= profile->maximum();
+	if(hi - lo < 1.0)
+		hi= lo + 1.0;
+	double yscale= (area.height() - 1) / (hi - lo);
+
+	// reduce the buckets to a min, max and average per pixel column
+	int w= area.width();
+	QVector<float> cmin(w), cmax(w), csum(w);
+	QVector<int> ccount(w, 0);
+	for(int i= 0; i < count; i++){
+		const ProfileBucket &b= profile->bucket(level, first + i);
+		if(b.count == 0)
+			continue;
+		int x= (int)(((double)i * bw / span) * (w - 1));
+		if(ccount[x] == 0){
+			cmin[x]= b.min;
+			cmax[x]= b.max;
+			csum[x]= 0.0;
+		}else{
+			cmin[x]= qMin(cmin[x], b.min);
+			cmax[x]= qMax(cmax[x], b.max);
+		}
+		csum[x] += b.sum;
+		ccount[x] += b.count;
+	}
+
+	QColor envelope(color);
+	envelope.setAlpha(96);
+	QPolygonF avg;
+	for(int x= 0; x < w; x++){
+		if(ccount[x] == 0)
+			continue;
+		int y0= area.bottom() - (int)((cmin[x] - lo) * yscale);
+		int y1= area.bottom() - (int)((cmax[x] - lo) * yscale);
+		painter.setPen(envelope);
+		painter.drawLine(area.left() + x, y0, area.left() + x, y1);
+		avg.append(QPointF(area.left() + x, area.bottom() - ((csum[x] / ccount[x]) - lo) * yscale));
+	}
+	painter.setPen(color);
+	painter.drawPolyline(avg);
+
+	// range labels
+	painter.setPen(Qt::white);
+	painter.drawText(area.adjusted(2, 0, 0, 0), Qt::AlignTop | Qt::AlignLeft, QString::number(profile->maximum() * scale, 'f', 1) + units);
+	painter.drawText(area.adjusted(2, 0, 0, 0), Qt::AlignBottom | Qt::AlignLeft, QString::number(profile->minimum() * scale, 'f', 1) + units);
+}
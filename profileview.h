@@ -0,0 +1,28 @@
+#ifndef PROFILEVIEW_H
+#define PROFILEVIEW_H
+
+#include <QWidget>
+
+#include "profile.h"
+
+// Draws the altitude and speed profiles of the current trip
+class ProfileView : public QWidget
+{
+	Q_OBJECT
+
+ public:
+	ProfileView(const Profile *altitude, const Profile *speed, QWidget *parent = 0);
+	void setMetric(bool);
+
+ protected:
+	void paintEvent(QPaintEvent *event);
+
+ private:
+	void drawProfile(QPainter &painter, const Profile *profile, const QRect &area, const QColor &color, float scale, const QString &units);
+
+	const Profile *altitude;
+	const Profile *speed;
+	bool use_metric;
+};
+
+#endif
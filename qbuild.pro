@@ -3,7 +3,10 @@ TARGET=qtpedometer
 
 CONFIG+=qtopia
 QTOPIA*=whereabouts
+QT*=network
 DEFINES+=QT_NO_DEBUG_OUTPUT
+# uncomment to print time to first screen and GPS bring-up on stderr
+#DEFINES+=STARTUP_BENCH
 
 # I18n info
 STRING_LANGUAGE=en_US
@@ -25,12 +28,38 @@ FORMS=\
 
 HEADERS=\
     qtpedometer.h\
-    compass.h
+    compass.h\
+    config.h\
+    track.h\
+    tilecache.h\
+    mapview.h\
+    profile.h\
+    profileview.h\
+    stepdetector.h\
+    accelerometer.h\
+    trip.h\
+    telemetry.h\
+    race.h\
+    checkpoint.h\
+    terrain.h
 
 SOURCES=\
     main.cpp\
     qtpedometer.cpp\
-    compass.cpp
+    compass.cpp\
+    config.cpp\
+    track.cpp\
+    tilecache.cpp\
+    mapview.cpp\
+    profile.cpp\
+    profileview.cpp\
+    stepdetector.cpp\
+    accelerometer.cpp\
+    trip.cpp\
+    telemetry.cpp\
+    race.cpp\
+    checkpoint.cpp\
+    terrain.cpp
 
 # Install rules
 target [
@@ -15,6 +15,7 @@
 #include <QNmeaWhereabouts>
 #include <QCloseEvent>
 #include <QTextStream>
+#include <QTimer>
 
 #include <math.h>
 
@@ -29,6 +30,7 @@
 QtPedometer::QtPedometer(QWidget *parent, Qt::WFlags f) :  QWidget(parent, f)
 {
 	qDebug("In QtPedometer()");
+	startup_time.start();
 #ifdef Q_WS_QWS
 	setObjectName("Pedometer");
 	QtopiaApplication::setInputMethodHint(this, QtopiaApplication::AlwaysOff);
@@ -36,23 +38,36 @@ QtPedometer::QtPedometer(QWidget *parent, Qt::WFlags f) :  QWidget(parent, f)
 	setWindowTitle(tr("Pedometer", "application header"));
 #endif
 	ui.setupUi(this);
-	compass= new Compass();
 
-	// get settings
-	QSettings settings("e4Networks", "Pedometer");
-	use_metric= settings.value("metric", false).toBool();
-	setMetric(use_metric);
-	speed_threshold= settings.value("threshold", 0.18).toDouble(); // M/S
-	distance_sensitivity= settings.value("sensitivity", 30).toInt(); // Meters
-	qDebug("speed_threshold= %6.2f m/s, distance_sensitivity= %d m", speed_threshold, distance_sensitivity);
+	// the compass, map and profile are only created when their tab is first shown
+	compass= NULL;
+	map_view= NULL;
+	profile_view= NULL;
+
+	// get settings, this is the only time they are read
+	config.load();
+	setMetric(config.use_metric);
+	trip.setSensitivity(config.distance_sensitivity);
+	trip.setSpeedThreshold(config.speed_threshold);
+	step_detector.setRate(config.accel_rate);
+	step_detector.setStrideLength(config.stride_mm);
+	accelerometer= NULL;
+	telemetry= NULL;
+	terrain= config.dem_dir.isEmpty() ? NULL : new Terrain(config.dem_dir);
+	racing= false;
+	race_finish_ms= -1;
+	started= false;
 
 	hidden= true;
 	whereabouts= NULL;
 	running= false;
-	last_update.clear();
-	saved_update.clear();
 	createMenus();
 	init();
+
+	// carry on with the trip if we were killed part way through it
+	checkpoint= new Checkpoint(config.checkpoint_file, config.checkpoint_journal);
+	last_checkpoint= 0;
+	resumeTrip();
 }
 
 QtPedometer::~QtPedometer()
@@ -62,6 +77,8 @@ QtPedometer::~QtPedometer()
 	QtopiaApplication::setPowerConstraint(QtopiaApplication::Enable);
 #endif
 	delete compass;
+	delete checkpoint;
+	delete terrain;
 }
 
 void QtPedometer::createMenus()
@@ -75,6 +92,10 @@ void QtPedometer::createMenus()
 	QAction *restoreAct= new QAction(tr("Restore waypoint"), this);
     connect(restoreAct, SIGNAL(triggered()), this, SLOT(restoreWayPoint()));
 	contextMenu->addAction(restoreAct);
+	race_action= new QAction(tr("Race saved trip"), this);
+	race_action->setCheckable(true);
+	connect(race_action, SIGNAL(toggled(bool)), this, SLOT(raceTrip(bool)));
+	contextMenu->addAction(race_action);
 	
 	contextMenu->addSeparator();
 	QAction *settingsAct= new QAction(tr("Settings..."), this);
@@ -85,40 +106,76 @@ void QtPedometer::createMenus()
 // Setup all Ui related to metric vs non-metric units
 void QtPedometer::setMetric(bool set)
 {
-	use_metric= set;
-	qDebug("set use metric to: %s", use_metric?"true":"false");
-	ui.feetButton->setText(use_metric ? "m" : "ft");
-	ui.wayMilesCheck->setText(use_metric ? "Km" : "miles");
+	config.use_metric= set;
+	qDebug("set use metric to: %s", config.use_metric?"true":"false");
+	ui.feetButton->setText(config.use_metric ? "m" : "ft");
+	ui.wayMilesCheck->setText(config.use_metric ? "Km" : "miles");
+	if(profile_view != NULL)
+		profile_view->setMetric(config.use_metric);
 }
 
 void QtPedometer::init()
 {
 	qDebug("In QtPedometer:init()");
 
-	// setup compass widget for drawing into
-	QVBoxLayout *vbox = new QVBoxLayout;
-	vbox->addWidget(compass);
-	ui.compassFrame->setLayout(vbox);
-
 	// sync up UI
 	ui.startButton->setDisabled(true);
 	ui.pauseButton->setDisabled(true);
 
+	connect(ui.tabWidget, SIGNAL(currentChanged(int)), this, SLOT(tabChanged(int)));
+	connect(ui.resetButton, SIGNAL(clicked()), this, SLOT(resetData()));
+	connect(ui.pauseButton, SIGNAL(clicked()), this, SLOT(pauseData()));
+	connect(ui.startButton, SIGNAL(clicked()), this, SLOT(startData()));
+	connect(ui.setWaypoint, SIGNAL(clicked()), this, SLOT(setWayPoint()));
+	connect(ui.clearWaypoint, SIGNAL(clicked()), this, SLOT(clearWayPoint()));
+
+	ui.status->setText("Initializing");
+
+	// bring up the location source once the event loop is running, so
+	// the first screen gets shown without waiting for the GPS plugin
+	QTimer::singleShot(0, this, SLOT(startLocation()));
+}
+
+void QtPedometer::startLocation()
+{
+	qDebug("In QtPedometer:startLocation()");
+
+	// -accel <file> replays recorded accelerometer data instead of using the device
+	QStringList args= QApplication::arguments();
+	QString accel_replay;
+	int i= args.indexOf("-accel");
+	if(i > 0){
+		accel_replay= args.value(i + 1);
+		args.removeAt(i);
+		if(i < args.size())
+			args.removeAt(i);
+	}
+
 	// setup gps plugin, can be "gpsd" or use the default
 	QString plugin;
-	if(QApplication::arguments().size() > 1){
-		plugin= QApplication::arguments().at(1);
+	if(args.size() > 1){
+		plugin= args.at(1);
 		qDebug("Using plugin %s\n", (const char *)plugin.toAscii());
 	}else
 		plugin= "";
 
+	startAccelerometer(accel_replay);
+
+	if(config.telemetry_port > 0){
+		telemetry= new TelemetryServer(this);
+		if(!telemetry->listen(config.telemetry_address, config.telemetry_port)){
+			delete telemetry;
+			telemetry= NULL;
+		}
+	}
+
 	
 	if(plugin.size() > 0){
 		// use a simulation for testing purposes, reads NMEA data from the given file
 		if(plugin == "sim"){
 			QString fn= "/root/nmea_sample.txt";
-			if(QApplication::arguments().size() > 2){
-				fn= QApplication::arguments().at(2);
+			if(args.size() > 2){
+				fn= args.at(2);
 			}
 			qDebug("using file: %s\n", (const char *)fn.toAscii());
 			
@@ -131,8 +188,8 @@ void QtPedometer::init()
 		}else{
 			// Use gpsd to the given host (gpsd must be started)
 			QString host= "";
-			if(QApplication::arguments().size() > 2){
-				host= QApplication::arguments().at(2);
+			if(args.size() > 2){
+				host= args.at(2);
 				qDebug("to host: %s\n", (const char *)host.toAscii());
 			}
 			whereabouts= QWhereaboutsFactory::create(plugin, host);
@@ -148,15 +205,110 @@ void QtPedometer::init()
 
 	connect(whereabouts, SIGNAL(updated(QWhereaboutsUpdate)), SLOT(updated(QWhereaboutsUpdate)));
 	connect(whereabouts, SIGNAL(stateChanged(QWhereabouts::State)), SLOT(stateChanged(QWhereabouts::State)));
-
-	connect(ui.resetButton, SIGNAL(clicked()), this, SLOT(resetData()));
-	connect(ui.pauseButton, SIGNAL(clicked()), this, SLOT(pauseData()));
-	connect(ui.startButton, SIGNAL(clicked()), this, SLOT(startData()));
-	connect(ui.setWaypoint, SIGNAL(clicked()), this, SLOT(setWayPoint()));
-	connect(ui.clearWaypoint, SIGNAL(clicked()), this, SLOT(clearWayPoint()));
  	
 	whereabouts->setUpdateInterval(1000); // update every second
 	whereabouts->startUpdates();
+
+#ifdef STARTUP_BENCH
+	qWarning("startup: location source started after %d ms", startup_time.elapsed());
+#endif
+}
+
+void QtPedometer::startAccelerometer(const QString &replay)
+{
+	accelerometer= new Accelerometer(&step_detector, this);
+	bool ok;
+	if(replay.isEmpty())
+		ok= accelerometer->openDevice(config.accel_device);
+	else{
+		qDebug("replaying accelerometer file: %s", (const char *)replay.toAscii());
+		ok= accelerometer->openReplay(replay);
+	}
+
+	if(!ok){
+		delete accelerometer;
+		accelerometer= NULL;
+		return;
+	}
+	connect(accelerometer, SIGNAL(stepped()), this, SLOT(stepped()));
+	accelerometer->setEnabled(running);
+}
+
+// create the compass widget the first time the Com tab is viewed
+void QtPedometer::createCompass()
+{
+	if(compass != NULL)
+		return;
+
+	qDebug("creating compass");
+	compass= new Compass();
+
+	// setup compass widget for drawing into
+	QVBoxLayout *vbox = new QVBoxLayout;
+	vbox->addWidget(compass);
+	ui.compassFrame->setLayout(vbox);
+
+	// catch up with what happened before it existed
+	if(current_update.dataValidityFlags() & QWhereaboutsUpdate::Course)
+		compass->setBearing(current_update.course());
+	compass->showGhost(racing);
+	if(!way_point.isNull()){
+		compass->showAzimuth(true);
+		if(!current_update.isNull())
+			compass->setAzimuth(current_update.coordinate().azimuthTo(way_point.coordinate()));
+	}
+}
+
+// create the map the first time the Map tab is viewed
+void QtPedometer::createMapView()
+{
+	if(map_view != NULL)
+		return;
+
+	qDebug("creating map, tiles from %s", (const char *)config.tile_dir.toAscii());
+	map_view= new MapView(&track, config.tile_dir);
+
+	QVBoxLayout *vbox = new QVBoxLayout;
+	vbox->addWidget(map_view);
+	ui.mapFrame->setLayout(vbox);
+
+	connect(ui.zoomInButton, SIGNAL(clicked()), map_view, SLOT(zoomIn()));
+	connect(ui.zoomOutButton, SIGNAL(clicked()), map_view, SLOT(zoomOut()));
+	connect(ui.followCheck, SIGNAL(toggled(bool)), map_view, SLOT(setFollow(bool)));
+	connect(map_view, SIGNAL(followChanged(bool)), ui.followCheck, SLOT(setChecked(bool)));
+
+	// catch up with what happened before it existed
+	if(!current_update.isNull())
+		map_view->setPosition(current_update.coordinate().latitude(), current_update.coordinate().longitude());
+	if(!way_point.isNull()){
+		map_view->setWayPoint(way_point.coordinate().latitude(), way_point.coordinate().longitude());
+		map_view->showWayPoint(true);
+	}
+}
+
+// create the profile chart the first time the Prof tab is viewed
+void QtPedometer::createProfileView()
+{
+	if(profile_view != NULL)
+		return;
+
+	qDebug("creating profile");
+	profile_view= new ProfileView(&altitude_profile, &speed_profile);
+	profile_view->setMetric(config.use_metric);
+
+	QVBoxLayout *vbox = new QVBoxLayout;
+	vbox->addWidget(profile_view);
+	ui.profileFrame->setLayout(vbox);
+}
+
+void QtPedometer::tabChanged(int)
+{
+	if(ui.tabWidget->currentWidget() == ui.tab_2)
+		createCompass();
+	else if(ui.tabWidget->currentWidget() == ui.tab_6)
+		createMapView();
+	else if(ui.tabWidget->currentWidget() == ui.tab_7)
+		createProfileView();
 }
 
 void QtPedometer::stateChanged(QWhereabouts::State state)
@@ -182,13 +334,16 @@ void QtPedometer::stateChanged(QWhereabouts::State state)
     }
 }
 
-void QtPedometer::updated(const QWhereaboutsUpdate &update)
+void QtPedometer::updated(const QWhereaboutsUpdate &fix)
 {
-	if (update.coordinate().type() == QWhereaboutsCoordinate::InvalidCoordinate){
+	if (fix.coordinate().type() == QWhereaboutsCoordinate::InvalidCoordinate){
 		qDebug("Invalid coordinate");
 		return;
 	}
 
+	// the GPS altitude is noisy, use the terrain height if we have it
+	const QWhereaboutsUpdate update= terrain != NULL ? correctAltitude(fix) : fix;
+
 	current_update= update;
 
 	QString pos= update.coordinate().toString(QWhereaboutsCoordinate::DegreesMinutesSecondsWithHemisphere);
@@ -198,7 +353,7 @@ void QtPedometer::updated(const QWhereaboutsUpdate &update)
 	ui.longitude->setText(list.at(1));
 
 	if(update.coordinate().type() == QWhereaboutsCoordinate::Coordinate3D){
-		if(use_metric)
+		if(config.use_metric)
 			ui.altitude->setText(QString::number(update.coordinate().altitude(), 'f', 3) + " m");
 		else
 			ui.altitude->setText(QString::number(update.coordinate().altitude() * METERS_TO_FEET, 'f', 3) + " ft"); // convert to feet
@@ -207,17 +362,18 @@ void QtPedometer::updated(const QWhereaboutsUpdate &update)
 	// set bearing
 	if(update.dataValidityFlags() & QWhereaboutsUpdate::Course){
 		ui.bearing->setText(QString::number(update.course(), 'f', 2) + QChar(0x00B0));   // degrees symbol
-		compass->setBearing(update.course());
+		if(compass != NULL)
+			compass->setBearing(update.course());
 	}
 
 	if(update.dataValidityFlags() & QWhereaboutsUpdate::GroundSpeed){
-		if(use_metric)
+		if(config.use_metric)
 			ui.speed->setText(QString::number(update.groundSpeed(), 'f', 3) + " m/s");
 		else
 			ui.speed->setText(QString::number(update.groundSpeed() * MPS_TO_MPH, 'f', 3) + " mph"); // convert to miles per hour
 	}
 	if(update.dataValidityFlags() & QWhereaboutsUpdate::VerticalSpeed){
-		if(use_metric)
+		if(config.use_metric)
 			ui.climb->setText(QString::number(update.verticalSpeed(), 'f', 3) + " m/s");
 		else
 			ui.climb->setText(QString::number(update.verticalSpeed() * MPS_TO_MPH, 'f', 3) + " mph"); // convert to miles per hour
@@ -228,12 +384,35 @@ void QtPedometer::updated(const QWhereaboutsUpdate &update)
 	// calculate average speed, and distance travelled
 	if(running){
 		calculateTrip(update);
+		track.append(update.coordinate().latitude(), update.coordinate().longitude());
+
+		// keep the altitude and speed profile for the trip
+		int ms= running_time.elapsed();
+		if(update.coordinate().type() == QWhereaboutsCoordinate::Coordinate3D)
+			altitude_profile.append(ms, update.coordinate().altitude());
+		if(update.dataValidityFlags() & QWhereaboutsUpdate::GroundSpeed)
+			speed_profile.append(ms, update.groundSpeed());
+		if(profile_view != NULL)
+			profile_view->update();
+
+		// remember the trip so it can be raced against once saved
+		recording.append(ms, trip.travelled(), update.coordinate().latitude(), update.coordinate().longitude());
+		if(racing)
+			calculateRace(update);
+
+		saveCheckpoint(true);
 	}
 
+	if(map_view != NULL)
+		map_view->setPosition(update.coordinate().latitude(), update.coordinate().longitude());
+
 	// if the way point is set then calculate and display the current distance to it
 	if(!way_point.isNull())
 		calculateWayPoint(update);
 
+	if(telemetry != NULL && telemetry->clientCount() > 0)
+		publishTelemetry(update);
+
 	// mostly for debugging
 	if(update.dataValidityFlags() & QWhereaboutsUpdate::HorizontalAccuracy){
 		qDebug("Horizontal Accuracy: %10.6f", update.horizontalAccuracy());
@@ -256,8 +435,54 @@ void QtPedometer::updated(const QWhereaboutsUpdate &update)
 		qDebug("Time Accuracy:  %10.6f", update.updateTimeAccuracy());
 }
 
+// returns the fix with its altitude from the terrain tiles, or unchanged
+// if there is no tile for it, or it has an altitude and we only fill in
+// the missing ones
+QWhereaboutsUpdate QtPedometer::correctAltitude(const QWhereaboutsUpdate &fix)
+{
+	const QWhereaboutsCoordinate &c= fix.coordinate();
+	if(!config.dem_replace && c.type() == QWhereaboutsCoordinate::Coordinate3D)
+		return fix;
+
+	double alt;
+	if(!terrain->elevation(c.latitude(), c.longitude(), alt))
+		return fix;
+
+	QWhereaboutsUpdate update= fix;
+	update.setCoordinate(QWhereaboutsCoordinate(c.latitude(), c.longitude(), alt));
+	return update;
+}
+
 // works out the Trip values
 void QtPedometer::calculateTrip(const QWhereaboutsUpdate &update)
+{
+	qreal start_distance= trip.distance();
+	if(trip.update(update)){
+		if(trip.partial() < 0.0)
+			ui.partial->clear();
+		else{
+			// display the partial distance, (ie the unaccumulated part)
+			qreal d= trip.partial() * (config.use_metric ? 1.0 : METERS_TO_FEET);
+			ui.partial->setText(QString::number(d, 'f', 1) + (config.use_metric ? " m" : " ft"));		
+		}
+	}
+	qreal distance= trip.distance();
+
+	// calibrate the stride length against the distance the GPS says we moved
+	if(distance > start_distance){
+		int stride= step_detector.strideLength();
+		step_detector.addGpsDistance(distance - start_distance);
+		if(step_detector.strideLength() != stride){
+			qDebug("stride length now %d mm", step_detector.strideLength());
+			config.saveStride(step_detector.strideLength());
+		}
+	}
+	showSteps();
+	showTrip();
+}
+
+// display the trip time, distance and average speed
+void QtPedometer::showTrip()
 {
 	// display trip time
 	char str[16];
@@ -267,88 +492,178 @@ void QtPedometer::calculateTrip(const QWhereaboutsUpdate &update)
 	int secs= (ms/1000) % 60;
 	snprintf(str, sizeof(str), "%02d:%02d:%02d", hrs, mins, secs);
 	ui.runningTime->setText(str);
-	int delta= 0;
-	//qDebug("Update time: %s", (const char *)update.updateTime().toString().toAscii());
-	if(!last_update.isNull()){
-		if(saved_update.isNull())
-		   saved_update= last_update;
-
-		// We use on of two methods to accumulate trip distance
-		// 1. is to wait until a certain distance has been travelled then add that to the distance
-		// 2. is to use the current speed over the ground returned by the GPS and multiply that by the time
-		//
-		// if distance_sensitivity is > 0 then we use 1. else we use 2.
-
-		if(distance_sensitivity > 0){ // meters from last saved point
-			// if we have travelled more than distance_sensitivity
-			// meters then accumulate that distance
-
-			// get elapsed time since last sampling period
-			QTime last= saved_update.updateTime();
-			QTime t= update.updateTime();
-			delta= last.msecsTo(t);
-			
-			// get distance from last sample period, however long it takes
-			qreal dist= saved_update.coordinate().distanceTo(update.coordinate());
-			qDebug("delta time= %d ms, dist= %10.6f m", delta, dist);
-			if(dist > distance_sensitivity){
-				distance += dist;
-				qDebug("1: cur dist: %10.6f, total: %10.6f", dist, distance);
-				saved_update= update;
-				ui.partial->clear();
-			}else{
-				// display the partial distance, (ie the unaccumulated part)
-				qreal d= dist * (use_metric ? 1.0 : METERS_TO_FEET);
-				ui.partial->setText(QString::number(d, 'f', 1) + (use_metric ? " m" : " ft"));		
-			}
-				
-		}else{ 
-			// get the speed calculated from the GPS, and use it to
-			// determine the distance covered since the last valid speed update
-			if(update.dataValidityFlags() & QWhereaboutsUpdate::GroundSpeed){
-				// get elapsed time since last update
-				QTime last= last_update.updateTime();
-				QTime t= update.updateTime();
-				delta= last.msecsTo(t);
-
-				// get measured speed
-				qreal speed= update.groundSpeed();
-				qDebug("delta time= %d ms, speed= %10.6f m.s", delta, speed);
-
-				// if we are going less than the speed threshold then presume
-				// we are not moving
-				if(speed < speed_threshold){
-					speed= 0.0;
-				}
-
-				// calculate distance travelled
-				qreal d= speed * (delta/1000.0);
-				distance += d;
-				qDebug("2: cur dist: %10.6f, total: %10.6f", d, distance);
-			}
-		}
-	}
-	last_update= update;
+	qreal distance= trip.distance();
 	
 	// display miles or feet, or meters or kilometers
 	if(ui.feetButton->isChecked()){
 		// display decimal meters or feet
-		qreal d= distance * (use_metric ? 1.0 : METERS_TO_FEET);
-		ui.distance->setText(QString::number(d, 'f', 1) + (use_metric ? " m" : " ft"));		
+		qreal d= distance * (config.use_metric ? 1.0 : METERS_TO_FEET);
+		ui.distance->setText(QString::number(d, 'f', 1) + (config.use_metric ? " m" : " ft"));		
 	}else{
 		// display decimal Km or miles
-		qreal d= distance * (use_metric ? 0.001 : METERS_TO_MILES);
-		ui.distance->setText(QString::number(d, 'f', 4) + (use_metric ? " Km" : " mi"));
+		qreal d= distance * (config.use_metric ? 0.001 : METERS_TO_MILES);
+		ui.distance->setText(QString::number(d, 'f', 4) + (config.use_metric ? " Km" : " mi"));
 	}
 
 	// calculate average speed which is total distance covered divided by running_time
 	qreal speed= distance / (ms/1000.0); // gets meters per sec
-	if(use_metric)
+	if(config.use_metric)
 		ui.aveSpeed->setText(QString::number(speed, 'f', 3) + " m/s");
 	else
 		ui.aveSpeed->setText(QString::number(speed * MPS_TO_MPH, 'f', 3) + " mph");
 }
 
+// Write the trip state, a full checkpoint every checkpoint_interval
+// seconds or when the state changes, otherwise just journal the fix
+void QtPedometer::saveCheckpoint(bool journal_only)
+{
+	Checkpoint::Record r;
+	r.state= running ? Checkpoint::Running : (started ? Checkpoint::Paused : Checkpoint::Stopped);
+	r.steps= step_detector.steps();
+	r.saved_at= Checkpoint::now();
+	r.elapsed_ms= started ? running_time.elapsed() : 0;
+	r.distance= trip.distance();
+
+	if(journal_only && r.saved_at - last_checkpoint < config.checkpoint_interval * 1000LL){
+		checkpoint->journal(r);
+		return;
+	}
+	checkpoint->write(r);
+	last_checkpoint= r.saved_at;
+}
+
+// pick the trip up from the last checkpoint, the time the app was not
+// running is not counted as trip time
+void QtPedometer::resumeTrip()
+{
+	Checkpoint::Record r;
+	if(!checkpoint->load(r) || r.state == Checkpoint::Stopped)
+		return;
+
+	qint64 elapsed= r.elapsed_ms;
+	qDebug("resuming trip, %10.1f m in %lld ms", r.distance, elapsed);
+
+	trip.restore(r.distance);
+	step_detector.restoreSteps(r.steps);
+	running_time= QTime::currentTime().addMSecs(-(int)(elapsed % (24 * 60 * 60 * 1000)));
+	started= true;
+	running= r.state == Checkpoint::Running;
+	ui.pauseButton->setText(running ? "Pause" : "Resume");
+	showTrip();
+}
+
+// one line of JSON with the fix and the trip state, in SI units
+void QtPedometer::publishTelemetry(const QWhereaboutsUpdate &update)
+{
+	QByteArray line;
+	line.reserve(320);
+	line += "{\"time\":\"";
+	line += update.updateDateTime().toUTC().toString("yyyy-MM-ddThh:mm:ss").toAscii();
+	line += "Z\",\"lat\":";
+	line += QByteArray::number(update.coordinate().latitude(), 'f', 7);
+	line += ",\"lon\":";
+	line += QByteArray::number(update.coordinate().longitude(), 'f', 7);
+	if(update.coordinate().type() == QWhereaboutsCoordinate::Coordinate3D){
+		line += ",\"alt\":";
+		line += QByteArray::number(update.coordinate().altitude(), 'f', 1);
+	}
+	if(update.dataValidityFlags() & QWhereaboutsUpdate::GroundSpeed){
+		line += ",\"speed\":";
+		line += QByteArray::number(update.groundSpeed(), 'f', 3);
+	}
+	if(update.dataValidityFlags() & QWhereaboutsUpdate::Course){
+		line += ",\"course\":";
+		line += QByteArray::number(update.course(), 'f', 1);
+	}
+
+	line += ",\"trip\":{\"running\":";
+	line += running ? "true" : "false";
+	if(running){
+		line += ",\"elapsed_ms\":";
+		line += QByteArray::number(running_time.elapsed());
+	}
+	line += ",\"distance\":";
+	line += QByteArray::number(trip.distance(), 'f', 1);
+	if(trip.partial() >= 0.0){
+		line += ",\"partial\":";
+		line += QByteArray::number(trip.partial(), 'f', 1);
+	}
+	line += ",\"steps\":";
+	line += QByteArray::number(step_detector.steps());
+	line += "}}\n";
+
+	telemetry->publish(line);
+}
+
+// Compare with the saved trip, by how much time we are ahead or behind
+// it at the same distance, and how far ahead or behind at the same time
+void QtPedometer::calculateRace(const QWhereaboutsUpdate &update)
+{
+	int ms= running_time.elapsed();
+	qreal d= trip.travelled();
+	qreal gap= d - race.distanceAt(ms);
+	int t= race.timeAt(d);
+
+	// once past the end of the saved trip the race is over, the result is
+	// the difference in the times taken to get there
+	if(t < 0 && race_finish_ms < 0)
+		race_finish_ms= ms;
+	int gap_ms= race_finish_ms >= 0 ? race.last().ms - race_finish_ms : t - ms;
+
+	int secs= qAbs(gap_ms) / 1000;
+	char str[16];
+	snprintf(str, sizeof(str), "%d:%02d", secs / 60, secs % 60);
+	if(race_finish_ms >= 0){
+		ui.raceGap->setText(QString(gap_ms >= 0 ? "finished ahead " : "finished behind ") + str);
+	}else{
+		qreal gd= qAbs(gap) * (config.use_metric ? 1.0 : METERS_TO_FEET);
+		ui.raceGap->setText(QString(gap_ms >= 0 ? "ahead " : "behind ") + str + ", " +
+							QString::number(gd, 'f', 0) + (config.use_metric ? " m" : " ft"));
+	}
+
+	// point to where the saved trip was at this time
+	if(compass != NULL){
+		double lat, longit;
+		race.positionAt(ms, lat, longit);
+		QWhereaboutsCoordinate ghost(lat, longit);
+		compass->setGhost(update.coordinate().azimuthTo(ghost));
+	}
+}
+
+void QtPedometer::raceTrip(bool flg)
+{
+	if(flg){
+		if(!race.load(config.race_file)){
+			QMessageBox::warning(this, tr("Race"), tr("No saved trip to race against."));
+			race_action->setChecked(false);
+			return;
+		}
+	}else{
+		race.clear();
+		ui.raceGap->clear();
+	}
+	racing= flg;
+	race_finish_ms= -1;
+	if(compass != NULL)
+		compass->showGhost(racing);
+}
+
+void QtPedometer::stepped()
+{
+	showSteps();
+}
+
+// display the step count with the distance it covers, and the cadence
+void QtPedometer::showSteps()
+{
+	if(accelerometer == NULL)
+		return;
+
+	qreal d= step_detector.distance() * (config.use_metric ? 0.001 : METERS_TO_MILES);
+	ui.steps->setText(QString::number(step_detector.steps()) + " / " + QString::number(d, 'f', 2) + (config.use_metric ? " Km" : " mi"));
+	ui.cadence->setText(QString::number(step_detector.cadence()) + " steps/min");
+}
+
 void QtPedometer::startData()
 {
 	if(running){
@@ -356,23 +671,35 @@ void QtPedometer::startData()
 			return;
 	}
 
-	last_update.clear();
-	saved_update.clear();
+	trip.reset();
 	ui.partial->clear();
-	distance= 0.0;
+	track.clear();
+	altitude_profile.clear();
+	speed_profile.clear();
+	step_detector.reset();
+	recording.clear();
+	race_finish_ms= -1;
+	ui.raceGap->clear();
+	ui.steps->clear();
+	ui.cadence->clear();
 	running_time.start();
 	running= true;
+	started= true;
+	if(accelerometer != NULL)
+		accelerometer->setEnabled(true);
 	ui.pauseButton->setText("Pause");
+	saveCheckpoint();
 }
 
 void QtPedometer::pauseData()
 {
 	running= !running;
-	if(!running){
-		last_update.clear();
-		saved_update.clear();
-	}
+	if(!running)
+		trip.pause();
+	if(accelerometer != NULL)
+		accelerometer->setEnabled(running);
 	ui.pauseButton->setText(running ? "Pause" : "Resume");
+	saveCheckpoint();
 }
 
 bool QtPedometer::resetData()
@@ -386,10 +713,26 @@ bool QtPedometer::resetData()
 		ui.distance->clear();
 		ui.runningTime->clear();
 		ui.partial->clear();
-		last_update.clear();
-		saved_update.clear();
+		ui.steps->clear();
+		ui.cadence->clear();
+		trip.reset();
+		track.clear();
+		altitude_profile.clear();
+		speed_profile.clear();
+		step_detector.reset();
+		recording.clear();
+		race_finish_ms= -1;
+		ui.raceGap->clear();
 		running= false;
+		started= false;
+		saveCheckpoint();
+		if(accelerometer != NULL)
+			accelerometer->setEnabled(false);
 		ui.pauseButton->setText("Pause");
+		if(map_view != NULL)
+			map_view->update();
+		if(profile_view != NULL)
+			profile_view->update();
 		return true;
 	}
 	return false;
@@ -398,6 +741,14 @@ bool QtPedometer::resetData()
 
 void QtPedometer::paintEvent(QPaintEvent *)
 {
+#ifdef STARTUP_BENCH
+	// the first frame, the window and its children are painted from here on
+	static bool painted= false;
+	if(!painted){
+		painted= true;
+		qWarning("startup: first screen painted after %d ms", startup_time.elapsed());
+	}
+#endif
 }
 
 void QtPedometer::showEvent(QShowEvent *)
@@ -419,9 +770,14 @@ void QtPedometer::closeEvent(QCloseEvent *event)
 								   tr("Are you sure you want to exit?"),
 								   QMessageBox::Yes | QMessageBox::No);
 	if(ret == QMessageBox::Yes){
-		if(whereabouts == NULL){
+		if(whereabouts != NULL){
 			whereabouts->stopUpdates();
 		}
+		// leave the trip paused, so it waits for Resume when next run
+		if(started){
+			running= false;
+			saveCheckpoint();
+		}
         event->accept();
     } else {
         event->ignore();
@@ -457,10 +813,20 @@ void QtPedometer::saveTrip()
 		out << "Partial: " << ui.partial->text() << endl;
 	}
 	out << "Speed: " << ui.aveSpeed->text() << endl;
+	if(!ui.steps->text().isEmpty()){
+		out << "Steps: " << ui.steps->text() << endl;
+	}
 	out << "=====================" << endl;
 
 	//QApplication::restoreOverrideCursor();
 	
+	// the track is kept so the next trip can race against this one
+	if(!recording.isEmpty() && !recording.save(config.race_file)){
+		QMessageBox::warning(this, tr("Pedometer"),
+							 tr("Cannot write file %1.").arg(config.race_file));
+		return;
+	}
+
 	QMessageBox::information(this, tr("Trip"), tr("Saved."));
 
 	return;
@@ -483,12 +849,15 @@ void QtPedometer::setWayPoint()
 	ui.wayPtLatitude->setText(list.at(0));
 	ui.wayPtLongitude->setText(list.at(1));
 	way_point= current_update;
-	compass->showAzimuth(true);
+	if(compass != NULL)
+		compass->showAzimuth(true);
+	if(map_view != NULL){
+		map_view->setWayPoint(current_update.coordinate().latitude(), current_update.coordinate().longitude());
+		map_view->showWayPoint(true);
+	}
 	
 	// save the waypoint
-	QSettings settings("e4Networks", "Pedometer");
-	settings.setValue("waypoint/lat", current_update.coordinate().latitude());
-	settings.setValue("waypoint/long", current_update.coordinate().longitude());
+	config.saveWayPoint(current_update.coordinate().latitude(), current_update.coordinate().longitude());
 }
 
 void QtPedometer::clearWayPoint()
@@ -500,7 +869,10 @@ void QtPedometer::clearWayPoint()
 		ui.wayPtLatitude->clear();
 		ui.wayPtLongitude->clear();
 		way_point.clear();
-		compass->showAzimuth(false);
+		if(compass != NULL)
+			compass->showAzimuth(false);
+		if(map_view != NULL)
+			map_view->showWayPoint(false);
 	}
 }
 
@@ -513,12 +885,13 @@ void QtPedometer::restoreWayPoint()
 		if(ret != QMessageBox::Yes)
 			return;
 	}
-	QSettings settings("e4Networks", "Pedometer");
-	double lat= settings.value("waypoint/lat").toDouble();
-	double longit= settings.value("waypoint/long").toDouble();
+	double lat= config.waypoint_lat;
+	double longit= config.waypoint_long;
 
 	QWhereaboutsCoordinate coord(lat, longit);
 	QWhereaboutsUpdate upd(coord, QDateTime::currentDateTime());
+	if(terrain != NULL)
+		upd= correctAltitude(upd);
 	way_point= upd;
 
 	QString pos= coord.toString(QWhereaboutsCoordinate::DegreesMinutesSecondsWithHemisphere);
@@ -527,7 +900,12 @@ void QtPedometer::restoreWayPoint()
 	QStringList list= pos.split(",");
 	ui.wayPtLatitude->setText(list.at(0));
 	ui.wayPtLongitude->setText(list.at(1));
-	compass->showAzimuth(true);
+	if(compass != NULL)
+		compass->showAzimuth(true);
+	if(map_view != NULL){
+		map_view->setWayPoint(lat, longit);
+		map_view->showWayPoint(true);
+	}
 }
 
 // This calculates and displays either the 2D distance or 3D distance
@@ -550,12 +928,12 @@ void QtPedometer::calculateWayPoint(const QWhereaboutsUpdate &update)
 
 	if(ui.wayMilesCheck->isChecked()){
 		// display decimal miles or Km
-		qreal m= dist * (use_metric ? 0.001 : METERS_TO_MILES);
-		ui.wayPointDistance->setText(QString::number(m, 'f', 4) + (use_metric ? " Km" : " mi"));
+		qreal m= dist * (config.use_metric ? 0.001 : METERS_TO_MILES);
+		ui.wayPointDistance->setText(QString::number(m, 'f', 4) + (config.use_metric ? " Km" : " mi"));
 	}else{
 		// display decimal feet or meters
-		qreal feet= dist * (use_metric ? 1.0 : METERS_TO_FEET);
-		ui.wayPointDistance->setText(QString::number(feet, 'f', 1) + (use_metric ? " m" : " ft"));
+		qreal feet= dist * (config.use_metric ? 1.0 : METERS_TO_FEET);
+		ui.wayPointDistance->setText(QString::number(feet, 'f', 1) + (config.use_metric ? " m" : " ft"));
 	}
 
 	// where is the way point? This is the number of degrees relative
@@ -563,7 +941,8 @@ void QtPedometer::calculateWayPoint(const QWhereaboutsUpdate &update)
 	// compass
 	qreal az= update.coordinate().azimuthTo(way_point.coordinate());
 	//qDebug("azimuth of waypoint= %6.2f", az);
-	compass->setAzimuth(az);
+	if(compass != NULL)
+		compass->setAzimuth(az);
 }
 
 #define PI 3.14159265
@@ -571,9 +950,9 @@ void QtPedometer::calculateWayPoint(const QWhereaboutsUpdate &update)
 
 qreal QtPedometer::distance3d(const QWhereaboutsCoordinate& from, const QWhereaboutsCoordinate& to)
 {
-	// take into account center of earth
-	double alt1= from.altitude() * 6370000.0;
-	double alt2= to.altitude() * 6370000.0;
+	// distance from the center of the earth
+	double alt1= 6370000.0 + from.altitude();
+	double alt2= 6370000.0 + to.altitude();
 
 	// convert degrees to radians
 	double lat1= DEG2RAD(from.latitude());
@@ -602,19 +981,18 @@ void QtPedometer::settings()
 	Ui::settingsDlg sui;
 	QDialog *dlg= new QDialog(this);
 	sui.setupUi(dlg);
-	sui.metric->setChecked(use_metric);
-	sui.sensitivity->setValue(distance_sensitivity);
+	sui.metric->setChecked(config.use_metric);
+	sui.sensitivity->setValue(config.distance_sensitivity);
 
 	dlg->showMaximized();
 	if(dlg->exec() == QDialog::Accepted){
-		distance_sensitivity= sui.sensitivity->value();
+		config.distance_sensitivity= sui.sensitivity->value();
+		trip.setSensitivity(config.distance_sensitivity);
 		bool flg= sui.metric->isChecked();
 		setMetric(flg);
 		
 		// save the settings
-		QSettings settings("e4Networks", "Pedometer");
-		settings.setValue("metric", flg);
-		settings.setValue("sensitivity", distance_sensitivity);
+		config.saveSettings();
 	}
 	delete dlg;
 }
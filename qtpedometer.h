@@ -6,6 +6,18 @@
 
 #include "ui_qtpedometer.h"
 #include "compass.h"
+#include "config.h"
+#include "track.h"
+#include "mapview.h"
+#include "profile.h"
+#include "profileview.h"
+#include "stepdetector.h"
+#include "accelerometer.h"
+#include "trip.h"
+#include "telemetry.h"
+#include "race.h"
+#include "checkpoint.h"
+#include "terrain.h"
 
 class QtPedometer : public QWidget
 {
@@ -16,7 +28,7 @@ class QtPedometer : public QWidget
 		virtual ~QtPedometer();
 
 	private slots:
-		void updated(const QWhereaboutsUpdate &update);
+		void updated(const QWhereaboutsUpdate &fix);
 		void stateChanged(QWhereabouts::State state);
 		bool resetData();
 		void startData();
@@ -26,6 +38,10 @@ class QtPedometer : public QWidget
 		void clearWayPoint();
 		void restoreWayPoint();
 		void settings();
+		void tabChanged(int);
+		void startLocation();
+		void stepped();
+		void raceTrip(bool);
 
 	protected:
 		void paintEvent(QPaintEvent *event);
@@ -40,22 +56,47 @@ class QtPedometer : public QWidget
 		void createMenus();
 		qreal distance3d(const QWhereaboutsCoordinate& from, const QWhereaboutsCoordinate& to);
 		void setMetric(bool);
+		void createCompass();
+		void createMapView();
+		void createProfileView();
+		void startAccelerometer(const QString &replay);
+		void showSteps();
+		void publishTelemetry(const QWhereaboutsUpdate &);
+		void calculateRace(const QWhereaboutsUpdate &);
+		void showTrip();
+		void saveCheckpoint(bool journal_only= false);
+		void resumeTrip();
+		QWhereaboutsUpdate correctAltitude(const QWhereaboutsUpdate &);
 
 		Ui::MainWindow ui;
+		Config config;
 		Compass *compass;
+		MapView *map_view;
+		Track track;
+		ProfileView *profile_view;
+		Profile altitude_profile;
+		Profile speed_profile;
+		StepDetector step_detector;
+		Accelerometer *accelerometer;
+		TelemetryServer *telemetry;
+		RaceTrack recording;
+		RaceTrack race;
+		bool racing;
+		int race_finish_ms;	// trip time the end of the race was passed, or -1
+		QAction *race_action;
+		Checkpoint *checkpoint;
+		qint64 last_checkpoint;
+		bool started;
+		Terrain *terrain;
 
 		bool hidden;
-		QWhereaboutsUpdate last_update;
-		QWhereaboutsUpdate saved_update;
 		QWhereaboutsUpdate current_update;
 		QWhereaboutsUpdate way_point;
 		QWhereabouts *whereabouts;
 		QTime running_time;
-		qreal distance;
+		QTime startup_time;
+		Trip trip;
 		bool running;
-		bool use_metric;
-		double speed_threshold;
-		int distance_sensitivity;
 };
 
 #endif
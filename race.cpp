@@ -0,0 +1,161 @@
+#include <QFile>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <stdio.h>
+
+#include "race.h"
+
+RaceTrack::RaceTrack()
+{
+	clear();
+}
+
+void RaceTrack::clear()
+{
+	points.clear();
+	distance_cursor= 0;
+	time_cursor= 0;
+}
+
+void RaceTrack::append(int ms, double distance, double lat, double longit)
+{
+	// keep the points in distance order, the partial distance of a trip
+	// can go back a little as the fix wanders
+	if(!points.isEmpty() && distance < points.last().distance)
+		distance= points.last().distance;
+
+	RacePoint p;
+	p.ms= ms;
+	p.distance= distance;
+	p.lat= lat;
+	p.longit= longit;
+	points.append(p);
+}
+
+bool RaceTrack::save(const QString &path) const
+{
+	QFile file(path);
+	if(!file.open(QFile::WriteOnly | QFile::Text | QFile::Truncate))
+		return false;
+
+	QTextStream out(&file);
+	out.setRealNumberNotation(QTextStream::FixedNotation);
+	for(int i= 0; i < points.size(); i++){
+		const RacePoint &p= points.at(i);
+		out.setRealNumberPrecision(1);
+		out << p.ms << " " << p.distance << " ";
+		out.setRealNumberPrecision(7);
+		out << p.lat << " " << p.longit << endl;
+	}
+	return true;
+}
+
+bool RaceTrack::load(const QString &path)
+{
+	QFile file(path);
+	if(!file.open(QFile::ReadOnly | QFile::Text))
+		return false;
+
+	clear();
+	char line[128];
+	RacePoint p;
+	while(file.readLine(line, sizeof(line)) > 0){
+		if(sscanf(line, "%d %lf %lf %lf", &p.ms, &p.distance, &p.lat, &p.longit) != 4)
+			continue;
+		// keep it in order, the searches depend on it
+		if(!points.isEmpty() && (p.ms < points.last().ms || p.distance < points.last().distance))
+			continue;
+		points.append(p);
+	}
+	qDebug("loaded %d race points from %s", points.size(), (const char *)path.toAscii());
+	return !points.isEmpty();
+}
+
+// first point at or past the distance
+int RaceTrack::indexAtDistance(double distance)
+{
+	int n= points.size();
+	if(distance_cursor > 0 && points.at(distance_cursor - 1).distance >= distance){
+		// gone backwards, binary search for it
+		int lo= 0, hi= distance_cursor - 1;
+		while(lo < hi){
+			int mid= (lo + hi) / 2;
+			if(points.at(mid).distance < distance)
+				lo= mid + 1;
+			else
+				hi= mid;
+		}
+		distance_cursor= lo;
+	}
+	while(distance_cursor < n && points.at(distance_cursor).distance < distance)
+		distance_cursor++;
+	return distance_cursor;
+}
+
+// first point at or past the time
+int RaceTrack::indexAtTime(int ms)
+{
+	int n= points.size();
+	if(time_cursor > 0 && points.at(time_cursor - 1).ms >= ms){
+		int lo= 0, hi= time_cursor - 1;
+		while(lo < hi){
+			int mid= (lo + hi) / 2;
+			if(points.at(mid).ms < ms)
+				lo= mid + 1;
+			else
+				hi= mid;
+		}
+		time_cursor= lo;
+	}
+	while(time_cursor < n && points.at(time_cursor).ms < ms)
+		time_cursor++;
+	return time_cursor;
+}
+
+int RaceTrack::timeAt(double distance)
+{
+	int i= indexAtDistance(distance);
+	if(i >= points.size())
+		return -1;
+	if(i == 0)
+		return points.at(0).ms;
+
+	// interpolate between the points either side
+	const RacePoint &a= points.at(i - 1);
+	const RacePoint &b= points.at(i);
+	double f= (distance - a.distance) / (b.distance - a.distance);
+	return a.ms + (int)(f * (b.ms - a.ms));
+}
+
+double RaceTrack::distanceAt(int ms)
+{
+	int i= indexAtTime(ms);
+	if(i >= points.size())
+		return points.isEmpty() ? 0.0 : points.last().distance;
+	if(i == 0)
+		return points.at(0).distance;
+
+	const RacePoint &a= points.at(i - 1);
+	const RacePoint &b= points.at(i);
+	double f= (double)(ms - a.ms) / (b.ms - a.ms);
+	return a.distance + f * (b.distance - a.distance);
+}
+
+void RaceTrack::positionAt(int ms, double &lat, double &longit)
+{
+	int i= indexAtTime(ms);
+	if(i >= points.size() || i == 0){
+		// before the start or after the end, it stays put
+		const RacePoint &p= i == 0 ? points.at(0) : points.last();
+		lat= p.lat;
+		longit= p.longit;
+		return;
+	}
+
+	const RacePoint &a= points.at(i - 1);
+	const RacePoint &b= points.at(i);
+	double f= (double)(ms - a.ms) / (b.ms - a.ms);
+	lat= a.lat + f * (b.lat - a.lat);
+	longit= a.longit + f * (b.longit - a.longit);
+}
@@ -0,0 +1,46 @@
+#ifndef RACE_H
+#define RACE_H
+
+#include <QVector>
+#include <QString>
+
+struct RacePoint
+{
+	int ms;				// trip time
+	double distance;	// trip distance so far, meters
+	double lat;
+	double longit;
+};
+
+// A trip recorded as time and distance along it, which a later trip can
+// be compared against. The points are in time and distance order, so a
+// live trip finds its place with a cursor that only moves forward, and a
+// binary search if it ever goes back.
+class RaceTrack
+{
+ public:
+	RaceTrack();
+	void clear();
+	void append(int ms, double distance, double lat, double longit);
+	bool isEmpty() const { return points.isEmpty(); }
+	const RacePoint &last() const { return points.last(); }
+
+	bool save(const QString &path) const;
+	bool load(const QString &path);
+
+	// trip time at which this track reached the distance, or -1 if it never did
+	int timeAt(double distance);
+	// distance and position reached by the given trip time
+	double distanceAt(int ms);
+	void positionAt(int ms, double &lat, double &longit);
+
+ private:
+	int indexAtDistance(double distance);
+	int indexAtTime(int ms);
+
+	QVector<RacePoint> points;
+	int distance_cursor;
+	int time_cursor;
+};
+
+#endif
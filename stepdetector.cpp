@@ -0,0 +1,145 @@
+#include "stepdetector.h"
+
+// a step can't be shorter than this, 4 steps a second is a sprint
+#define MIN_STEP_MS 250
+// cadence goes to zero if there has not been a step for this long
+#define MAX_STEP_MS 2000
+// smallest peak counted as a step, in mg
+#define MIN_THRESHOLD (60 << 8)
+// GPS distance needed before the stride length is updated
+#define CALIBRATE_METERS 50.0
+// strides outside this are not walking, eg cycling or in a car
+#define MIN_STRIDE_MM 300
+#define MAX_STRIDE_MM 2000
+
+StepDetector::StepDetector(int rate)
+{
+	stride_mm= 750;
+	setRate(rate);
+	reset();
+}
+
+// pick the filter shifts for the rate samples arrive at, both are single
+// pole, the high pass corner is about 0.5 Hz to remove gravity and the
+// low pass corner about 2 Hz, above 80 Hz shifts of 5 and 3 else 4 and 2
+void StepDetector::setRate(int hz)
+{
+	if(hz >= 80){
+		hp_shift= 5;
+		lp_shift= 3;
+	}else{
+		hp_shift= 4;
+		lp_shift= 2;
+	}
+}
+
+void StepDetector::reset()
+{
+	dc= 0;
+	lp= 0;
+	prev= 0;
+	envelope= 0;
+	armed= false;
+	primed= false;
+	last_step_ms= 0;
+	last_sample_ms= 0;
+	for(int i= 0; i < Intervals; i++)
+		intervals[i]= 0;
+	interval_pos= 0;
+	step_count= 0;
+	calib_meters= 0.0;
+	calib_steps= 0;
+}
+
+int StepDetector::isqrt(unsigned int n)
+{
+	unsigned int root= 0;
+	unsigned int bit= 1u << 30;
+	while(bit > n)
+		bit >>= 2;
+	while(bit != 0){
+		if(n >= root + bit){
+			n -= root + bit;
+			root= (root >> 1) + bit;
+		}else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+bool StepDetector::sample(int ms, int x, int y, int z)
+{
+	int v= isqrt(x*x + y*y + z*z) << 8;
+
+	// start the gravity estimate at the first sample rather than ramping up from 0
+	if(!primed){
+		dc= v;
+		primed= true;
+	}
+	dc += (v - dc) >> hp_shift;
+	lp += ((v - dc) - lp) >> lp_shift;
+
+	// peak height decays so the threshold follows a change of pace
+	envelope -= envelope >> 9;
+	int threshold= envelope / 2;
+	if(threshold < MIN_THRESHOLD)
+		threshold= MIN_THRESHOLD;
+
+	bool step= false;
+	if(armed && lp < prev && prev > threshold){
+		// prev was a peak
+		armed= false;
+		envelope += (prev - envelope) >> 2;
+		int interval= ms - last_step_ms;
+		if(interval >= MIN_STEP_MS){
+			if(interval <= MAX_STEP_MS){
+				intervals[interval_pos]= interval;
+				interval_pos= (interval_pos + 1) % Intervals;
+			}
+			last_step_ms= ms;
+			step_count++;
+			step= true;
+		}
+	}else if(!armed && lp < 0){
+		// need to go back through zero before the next peak
+		armed= true;
+	}
+	prev= lp;
+	last_sample_ms= ms;
+	return step;
+}
+
+int StepDetector::cadence() const
+{
+	if(step_count == 0 || last_sample_ms - last_step_ms > MAX_STEP_MS)
+		return 0;
+
+	int sum= 0;
+	int n= 0;
+	for(int i= 0; i < Intervals; i++){
+		if(intervals[i] > 0){
+			sum += intervals[i];
+			n++;
+		}
+	}
+	return sum > 0 ? (60000 * n) / sum : 0;
+}
+
+// compare the GPS distance with the steps taken over it, and move the
+// stride length a quarter of the way towards what was measured
+void StepDetector::addGpsDistance(double meters)
+{
+	calib_meters += meters;
+	if(calib_meters < CALIBRATE_METERS)
+		return;
+
+	int n= step_count - calib_steps;
+	if(n > 0){
+		int measured= (int)((calib_meters * 1000.0) / n);
+		if(measured >= MIN_STRIDE_MM && measured <= MAX_STRIDE_MM)
+			stride_mm += (measured - stride_mm) / 4;
+	}
+	calib_meters= 0.0;
+	calib_steps= step_count;
+}
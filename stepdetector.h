@@ -0,0 +1,56 @@
+#ifndef STEPDETECTOR_H
+#define STEPDETECTOR_H
+
+// Detects walking steps from accelerometer samples. The magnitude of
+// acceleration is band-pass filtered with shift only fixed-point filters
+// and steps are the peaks above an adaptive threshold. Nothing is
+// allocated per sample so it can be fed at 50-100 Hz.
+//
+// Stride length is calibrated from GPS distance when there is a fix.
+class StepDetector
+{
+ public:
+	StepDetector(int rate= 100);
+	void setRate(int hz);
+	void reset();
+
+	// ms is the sample time, x, y and z are in mg
+	// returns true if the sample completed a step
+	bool sample(int ms, int x, int y, int z);
+
+	// GPS distance moved in meters, used to calibrate the stride length
+	void addGpsDistance(double meters);
+
+	int steps() const { return step_count; }
+	// the restored steps are not counted against the next GPS calibration
+	void restoreSteps(int n) { step_count= n; calib_steps= n; }
+	int cadence() const;			// steps per minute
+	int strideLength() const { return stride_mm; }
+	void setStrideLength(int mm) { stride_mm= mm; }
+	double distance() const { return (step_count * (double)stride_mm) / 1000.0; }
+
+ private:
+	enum { Intervals= 4 };
+
+	static int isqrt(unsigned int);
+
+	int hp_shift;
+	int lp_shift;
+	int dc;				// gravity estimate, Q8 mg
+	int lp;				// band-passed signal, Q8 mg
+	int prev;
+	int envelope;		// recent peak height, Q8 mg
+	bool armed;
+	bool primed;
+	int last_step_ms;
+	int last_sample_ms;
+	int intervals[Intervals];
+	int interval_pos;
+	int step_count;
+
+	int stride_mm;
+	double calib_meters;
+	int calib_steps;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QtDebug>
+
+#include "telemetry.h"
+
+// a client with more than this waiting in its socket is falling behind
+#define MAX_BACKLOG 4096
+// clients have nothing to say, this is all that is buffered from each
+#define MAX_READ_BUFFER 256
+
+TelemetryServer::TelemetryServer(QObject *parent) : QObject(parent)
+{
+	server= new QTcpServer(this);
+	connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+TelemetryServer::~TelemetryServer()
+{
+	for(int i= 0; i < clients.size(); i++)
+		clients[i].socket->abort();
+}
+
+bool TelemetryServer::listen(const QString &address, int port)
+{
+	if(!server->listen(QHostAddress(address), port)){
+		qDebug("telemetry cannot listen on %s:%d: %s", (const char *)address.toAscii(), port,
+			   (const char *)server->errorString().toAscii());
+		return false;
+	}
+	qDebug("telemetry listening on %s:%d", (const char *)address.toAscii(), port);
+	return true;
+}
+
+void TelemetryServer::newConnection()
+{
+	while(server->hasPendingConnections()){
+		QTcpSocket *socket= server->nextPendingConnection();
+		if(clients.size() >= MaxClients){
+			socket->abort();
+			socket->deleteLater();
+			continue;
+		}
+
+		Client client;
+		client.socket= socket;
+		clients.append(client);
+		socket->setReadBufferSize(MAX_READ_BUFFER);
+		connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten()));
+		connect(socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+		connect(socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+		qDebug("telemetry client connected, %d clients", clients.size());
+	}
+}
+
+int TelemetryServer::find(QObject *socket) const
+{
+	for(int i= 0; i < clients.size(); i++){
+		if(clients.at(i).socket == socket)
+			return i;
+	}
+	return -1;
+}
+
+// discard whatever the client sent so it is not kept
+void TelemetryServer::readyRead()
+{
+	QTcpSocket *socket= qobject_cast<QTcpSocket *>(sender());
+	if(socket != NULL)
+		socket->readAll();
+}
+
+void TelemetryServer::disconnected()
+{
+	int i= find(sender());
+	if(i < 0)
+		return;
+	clients[i].socket->deleteLater();
+	clients.removeAt(i);
+	qDebug("telemetry client gone, %d clients", clients.size());
+}
+
+// the line is built once and shared by all clients
+void TelemetryServer::publish(const QByteArray &line)
+{
+	for(int i= 0; i < clients.size(); i++)
+		send(clients[i], line);
+}
+
+void TelemetryServer::send(Client &client, const QByteArray &line)
+{
+	if(client.socket->bytesToWrite() < MAX_BACKLOG){
+		client.socket->write(line);
+		client.pending.clear();
+	}else
+		client.pending= line;	// coalesce, only the latest is kept
+}
+
+// a slow client has caught up a bit, give it the latest update it missed
+void TelemetryServer::bytesWritten()
+{
+	int i= find(sender());
+	if(i < 0)
+		return;
+	Client &client= clients[i];
+	if(!client.pending.isEmpty() && client.socket->bytesToWrite() < MAX_BACKLOG){
+		client.socket->write(client.pending);
+		client.pending.clear();
+	}
+}
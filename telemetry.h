@@ -0,0 +1,49 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+
+class QTcpServer;
+class QTcpSocket;
+
+// Publishes each fix and the trip state as a line of JSON to every
+// connected TCP client. A client that is slow to read has at most one
+// backlog of socket data plus the latest update waiting, older updates
+// it has not taken yet are replaced, so it never holds up the GPS
+// update or grows memory. Anything a client sends is thrown away.
+class TelemetryServer : public QObject
+{
+	Q_OBJECT
+
+ public:
+	enum { MaxClients= 256 };
+
+	TelemetryServer(QObject *parent = 0);
+	~TelemetryServer();
+	bool listen(const QString &address, int port);
+	void publish(const QByteArray &line);
+	int clientCount() const { return clients.size(); }
+
+ private slots:
+	void newConnection();
+	void bytesWritten();
+	void readyRead();
+	void disconnected();
+
+ private:
+	struct Client
+	{
+		QTcpSocket *socket;
+		QByteArray pending;		// latest update not yet written
+	};
+
+	void send(Client &client, const QByteArray &line);
+	int find(QObject *socket) const;
+
+	QTcpServer *server;
+	QList<Client> clients;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include <QFile>
+#include <QtDebug>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "terrain.h"
+
+#define HGT_VOID -32768
+
+Terrain::Terrain(const QString &dir)
+{
+	dem_dir= dir;
+}
+
+Terrain::~Terrain()
+{
+	qDeleteAll(tiles.begin(), tiles.end());
+}
+
+Terrain::Tile *Terrain::open(int lat, int longit)
+{
+	Tile *t= new Tile;
+	t->lat= lat;
+	t->longit= longit;
+	t->file= NULL;
+	t->data= NULL;
+	t->size= 0;
+
+	// eg N49W124.hgt has the corner at 49N 124W
+	char name[32];
+	snprintf(name, sizeof(name), "%c%02d%c%03d.hgt", lat >= 0 ? 'N' : 'S', abs(lat), longit >= 0 ? 'E' : 'W', abs(longit));
+	QFile *file= new QFile(dem_dir + "/" + name);
+	if(!file->open(QIODevice::ReadOnly)){
+		delete file;
+		return t;
+	}
+
+	int size= (int)sqrt(file->size() / 2.0);
+	if(size < 2 || (qint64)size * size * 2 != file->size()){
+		qDebug("%s is not an hgt tile", name);
+		delete file;
+		return t;
+	}
+
+	t->data= file->map(0, file->size());
+	if(t->data == NULL){
+		qDebug("Cannot map %s", name);
+		delete file;
+		return t;
+	}
+	t->file= file;
+	t->size= size;
+	qDebug("mapped terrain tile %s, %d posts", name, size);
+	return t;
+}
+
+// find the tile, most likely the same one as last time
+Terrain::Tile *Terrain::tile(int lat, int longit)
+{
+	for(int i= 0; i < tiles.size(); i++){
+		Tile *t= tiles.at(i);
+		if(t->lat == lat && t->longit == longit){
+			if(i > 0)
+				tiles.move(i, 0);
+			return t;
+		}
+	}
+
+	// missing tiles are kept too, so we don't keep looking for them
+	Tile *t= open(lat, longit);
+	tiles.prepend(t);
+	if(tiles.size() > MaxTiles)
+		delete tiles.takeLast();
+	return t;
+}
+
+static inline int post(const uchar *data, int size, int row, int col)
+{
+	const uchar *p= data + 2 * (row * size + col);
+	return (qint16)((p[0] << 8) | p[1]);
+}
+
+double Terrain::interpolate(const Tile *t, double lat, double longit, bool &ok)
+{
+	int n= t->size - 1;
+	double y= (t->lat + 1 - lat) * n;
+	double x= (longit - t->longit) * n;
+	int row= qMin((int)y, n - 1);
+	int col= qMin((int)x, n - 1);
+	double fy= y - row;
+	double fx= x - col;
+
+	int h[4]= {
+		post(t->data, t->size, row, col),
+		post(t->data, t->size, row, col + 1),
+		post(t->data, t->size, row + 1, col),
+		post(t->data, t->size, row + 1, col + 1)
+	};
+	double w[4]= {
+		(1 - fx) * (1 - fy),
+		fx * (1 - fy),
+		(1 - fx) * fy,
+		fx * fy
+	};
+
+	// leave out any voids and weight the rest
+	double sum= 0.0, weight= 0.0;
+	for(int i= 0; i < 4; i++){
+		if(h[i] != HGT_VOID){
+			sum += h[i] * w[i];
+			weight += w[i];
+		}
+	}
+	ok= weight > 0.0;
+	return ok ? sum / weight : 0.0;
+}
+
+bool Terrain::elevation(double lat, double longit, double &alt)
+{
+	Tile *t= tile((int)floor(lat), (int)floor(longit));
+	if(t->data == NULL)
+		return false;
+
+	bool ok;
+	double h= interpolate(t, lat, longit, ok);
+	if(ok)
+		alt= h;
+	return ok;
+}
+
+int Terrain::elevations(const double *lat, const double *longit, double *alt, int n)
+{
+	int found= 0;
+	Tile *t= NULL;
+	for(int i= 0; i < n; i++){
+		int tlat= (int)floor(lat[i]);
+		int tlong= (int)floor(longit[i]);
+		if(t == NULL || t->lat != tlat || t->longit != tlong)
+			t= tile(tlat, tlong);
+		if(t->data == NULL)
+			continue;
+
+		bool ok;
+		double h= interpolate(t, lat[i], longit[i], ok);
+		if(ok){
+			alt[i]= h;
+			found++;
+		}
+	}
+	return found;
+}
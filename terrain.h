@@ -0,0 +1,47 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <QString>
+#include <QList>
+
+class QFile;
+
+// Terrain elevation from SRTM .hgt tiles in a local directory. Tiles are
+// memory mapped when first needed and a few are kept open, the heights
+// are bilinear interpolated from the four posts around the point.
+class Terrain
+{
+ public:
+	enum { MaxTiles= 9 };
+
+	Terrain(const QString &dir);
+	~Terrain();
+
+	// height in meters above sea level, false if there is no tile for it
+	bool elevation(double lat, double longit, double &alt);
+	// the same for a whole track, eg one loaded from a file, returns how
+	// many were found, the others are left alone. The tile is only looked
+	// up again when the track leaves it.
+	int elevations(const double *lat, const double *longit, double *alt, int n);
+
+ private:
+	struct Tile
+	{
+		int lat;			// south west corner
+		int longit;
+		QFile *file;		// NULL if there is no tile here
+		const uchar *data;	// big endian int16, rows north to south
+		int size;			// posts per side, 1201 or 3601
+
+		~Tile() { delete file; }	// which unmaps it
+	};
+
+	Tile *tile(int lat, int longit);
+	Tile *open(int lat, int longit);
+	static double interpolate(const Tile *t, double lat, double longit, bool &ok);
+
+	QString dem_dir;
+	QList<Tile *> tiles;	// most recently used first
+};
+
+#endif
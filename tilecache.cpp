@@ -0,0 +1,119 @@
+#include <QtDebug>
+
+#include "tilecache.h"
+
+// only this many outstanding requests are kept, older ones have usually
+// been panned away from and are dropped
+#define MAX_QUEUED 32
+
+TileLoader::TileLoader(const QString &dir, QObject *parent) : QThread(parent)
+{
+	tile_dir= dir;
+	quit= false;
+}
+
+TileLoader::~TileLoader()
+{
+	mutex.lock();
+	quit= true;
+	condition.wakeOne();
+	mutex.unlock();
+	wait();
+}
+
+void TileLoader::request(int z, int x, int y)
+{
+	Request r;
+	r.z= z;
+	r.x= x;
+	r.y= y;
+
+	mutex.lock();
+	queue.append(r);
+	bool full= queue.size() > MAX_QUEUED;
+	if(full)
+		r= queue.takeFirst();
+	condition.wakeOne();
+	mutex.unlock();
+
+	if(full)
+		emit dropped(r.z, r.x, r.y);
+}
+
+void TileLoader::run()
+{
+	forever{
+		mutex.lock();
+		while(queue.isEmpty() && !quit)
+			condition.wait(&mutex);
+		if(quit){
+			mutex.unlock();
+			return;
+		}
+		Request r= queue.takeLast();
+		mutex.unlock();
+
+		// a missing tile is reported as a null image so it is not asked for again
+		QString fn= QString("%1/%2/%3/%4.png").arg(tile_dir).arg(r.z).arg(r.x).arg(r.y);
+		QImage image(fn);
+		if(!image.isNull() && image.format() != QImage::Format_RGB16)
+			image= image.convertToFormat(QImage::Format_RGB16);
+
+		emit loaded(r.z, r.x, r.y, image);
+	}
+}
+
+TileCache::TileCache(const QString &dir, int max_kbytes, QObject *parent) : QObject(parent)
+{
+	cache.setMaxCost(max_kbytes);
+	loader= new TileLoader(dir, this);
+	connect(loader, SIGNAL(loaded(int, int, int, QImage)), this, SLOT(loaded(int, int, int, QImage)), Qt::QueuedConnection);
+	connect(loader, SIGNAL(dropped(int, int, int)), this, SLOT(dropped(int, int, int)));
+
+	// otherwise the loader would look for tiles from the root directory
+	have_tiles= !dir.isEmpty();
+	if(have_tiles)
+		loader->start(QThread::LowPriority);
+}
+
+quint64 TileCache::key(int z, int x, int y)
+{
+	return ((quint64)z << 56) | ((quint64)(quint32)x << 28) | (quint64)(quint32)y;
+}
+
+const QImage *TileCache::tile(int z, int x, int y)
+{
+	if(!have_tiles)
+		return NULL;
+
+	quint64 k= key(z, x, y);
+	QImage *image= cache.object(k);
+	if(image != NULL)
+		return image;
+
+	if(!pending.contains(k)){
+		pending.insert(k);
+		loader->request(z, x, y);
+	}
+	return NULL;
+}
+
+const QImage *TileCache::cached(int z, int x, int y)
+{
+	return cache.object(key(z, x, y));
+}
+
+void TileCache::loaded(int z, int x, int y, const QImage &image)
+{
+	quint64 k= key(z, x, y);
+	pending.remove(k);
+	int cost= qMax(1, image.numBytes() / 1024);
+	cache.insert(k, new QImage(image), cost);
+	emit tileReady();
+}
+
+// the loader gave up on this one, so ask again if it is still wanted
+void TileCache::dropped(int z, int x, int y)
+{
+	pending.remove(key(z, x, y));
+}
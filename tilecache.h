@@ -0,0 +1,74 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QCache>
+#include <QSet>
+#include <QImage>
+
+// Decodes tile images off the GUI thread, most recent request first
+class TileLoader : public QThread
+{
+	Q_OBJECT
+
+ public:
+	TileLoader(const QString &dir, QObject *parent = 0);
+	~TileLoader();
+	void request(int z, int x, int y);
+
+ signals:
+	void loaded(int z, int x, int y, const QImage &image);
+	void dropped(int z, int x, int y);
+
+ protected:
+	void run();
+
+ private:
+	struct Request
+	{
+		int z, x, y;
+	};
+
+	QString tile_dir;
+	QMutex mutex;
+	QWaitCondition condition;
+	QList<Request> queue;
+	bool quit;
+};
+
+// A bounded LRU cache of decoded map tiles read from a local directory
+// laid out as <dir>/<zoom>/<x>/<y>.png, no network access is ever made
+class TileCache : public QObject
+{
+	Q_OBJECT
+
+ public:
+	TileCache(const QString &dir, int max_kbytes, QObject *parent = 0);
+
+	// returns the tile if it is decoded, otherwise NULL and the tile is
+	// queued for loading, tileReady() is emitted when it arrives. With no
+	// tile directory nothing is ever loaded.
+	const QImage *tile(int z, int x, int y);
+	// as above but never queues a load, used for lower zoom fallbacks
+	const QImage *cached(int z, int x, int y);
+
+ signals:
+	void tileReady();
+
+ private slots:
+	void loaded(int z, int x, int y, const QImage &image);
+	void dropped(int z, int x, int y);
+
+ private:
+	static quint64 key(int z, int x, int y);
+
+	TileLoader *loader;
+	bool have_tiles;	// false if there is no tile directory
+	QCache<quint64, QImage> cache;
+	QSet<quint64> pending;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <math.h>
+
+#include "track.h"
+
+// a point is only kept at a zoom level if it is at least this many
+// pixels across or down from the last point kept at that level
+#define LOD_PIXELS 2.0
+#define TILE_SIZE 256.0
+#define PI 3.14159265358979
+
+Track::Track()
+{
+	for(int z= MinZoom; z <= MaxZoom; z++){
+		levels[z - MinZoom].tolerance= LOD_PIXELS / (TILE_SIZE * (1 << z));
+	}
+	total= 0;
+}
+
+void Track::clear()
+{
+	for(int i= 0; i <= MaxZoom - MinZoom; i++){
+		levels[i].points.clear();
+		levels[i].chunks.clear();
+	}
+	total= 0;
+}
+
+TrackPoint Track::project(double lat, double longit)
+{
+	TrackPoint pt;
+	double s= sin(lat * PI / 180.0);
+	pt.x= (longit + 180.0) / 360.0;
+	pt.y= 0.5 - log((1.0 + s) / (1.0 - s)) / (4.0 * PI);
+	return pt;
+}
+
+void Track::append(double lat, double longit)
+{
+	TrackPoint pt= project(lat, longit);
+	for(int i= 0; i <= MaxZoom - MinZoom; i++)
+		add(levels[i], pt);
+	total++;
+}
+
+// simplification done incrementally as each fix arrives, a point is
+// dropped if it is within the tolerance of the last point kept on both
+// axes, ie inside a box around it
+void Track::add(Level &level, const TrackPoint &pt)
+{
+	int n= level.points.size();
+	if(n > 0){
+		const TrackPoint &last= level.points.at(n - 1);
+		if(fabs(pt.x - last.x) < level.tolerance && fabs(pt.y - last.y) < level.tolerance)
+			return;
+	}
+
+	// the bounds of a chunk also take in the last point of the previous
+	// chunk, so the segment joining the two is inside them, drawTrack()
+	// starts a chunk from that point
+	if(n % ChunkSize == 0){
+		TrackBounds b;
+		b.x0= b.x1= pt.x;
+		b.y0= b.y1= pt.y;
+		if(n > 0){
+			const TrackPoint &last= level.points.at(n - 1);
+			b.x0= qMin(b.x0, last.x);
+			b.x1= qMax(b.x1, last.x);
+			b.y0= qMin(b.y0, last.y);
+			b.y1= qMax(b.y1, last.y);
+		}
+		level.chunks.append(b);
+	}else{
+		TrackBounds &b= level.chunks[level.chunks.size() - 1];
+		b.x0= qMin(b.x0, pt.x);
+		b.x1= qMax(b.x1, pt.x);
+		b.y0= qMin(b.y0, pt.y);
+		b.y1= qMax(b.y1, pt.y);
+	}
+	level.points.append(pt);
+}
+
+const QVector<TrackPoint> &Track::points(int zoom) const
+{
+	return levels[qBound((int)MinZoom, zoom, (int)MaxZoom) - MinZoom].points;
+}
+
+const QVector<TrackBounds> &Track::chunks(int zoom) const
+{
+	return levels[qBound((int)MinZoom, zoom, (int)MaxZoom) - MinZoom].chunks;
+}
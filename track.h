@@ -0,0 +1,53 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <QVector>
+
+// a point in normalized spherical mercator coordinates, 0..1 across the world,
+// doubles as a float qreal on ARM is not precise enough at street zoom levels
+struct TrackPoint
+{
+	double x;
+	double y;
+};
+
+// bounding box of a run of points
+struct TrackBounds
+{
+	double x0, y0, x1, y1;
+};
+
+// The current trip track, kept simplified for each map zoom level
+// so drawing only has to touch the points visible at that level
+class Track
+{
+ public:
+	enum { MinZoom= 1, MaxZoom= 18, ChunkSize= 256 };
+
+	Track();
+	void clear();
+	void append(double lat, double longit);
+	int count() const { return total; }
+
+	// simplified points for the given zoom level, and the bounds of each
+	// ChunkSize run of them so whole runs can be culled
+	const QVector<TrackPoint> &points(int zoom) const;
+	const QVector<TrackBounds> &chunks(int zoom) const;
+
+	static TrackPoint project(double lat, double longit);
+
+ private:
+	struct Level
+	{
+		double tolerance;
+		QVector<TrackPoint> points;
+		QVector<TrackBounds> chunks;
+	};
+
+	void add(Level &level, const TrackPoint &pt);
+
+	Level levels[MaxZoom - MinZoom + 1];
+	int total;
+};
+
+#endif
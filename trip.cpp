@@ -0,0 +1,97 @@
+#include <QtDebug>
+
+#include "trip.h"
+
+Trip::Trip()
+{
+	speed_threshold= 0.18;
+	distance_sensitivity= 30;
+	reset();
+}
+
+void Trip::reset()
+{
+	pause();
+	total= 0.0;
+}
+
+void Trip::pause()
+{
+	last_update.clear();
+	saved_update.clear();
+	partial_distance= -1.0;
+}
+
+void Trip::restore(qreal distance)
+{
+	pause();
+	total= distance;
+}
+
+bool Trip::update(const QWhereaboutsUpdate &update)
+{
+	bool changed= false;
+	int delta= 0;
+	//qDebug("Update time: %s", (const char *)update.updateTime().toString().toAscii());
+	if(!last_update.isNull()){
+		if(saved_update.isNull())
+		   saved_update= last_update;
+
+		// We use on of two methods to accumulate trip distance
+		// 1. is to wait until a certain distance has been travelled then add that to the distance
+		// 2. is to use the current speed over the ground returned by the GPS and multiply that by the time
+		//
+		// if distance_sensitivity is > 0 then we use 1. else we use 2.
+
+		if(distance_sensitivity > 0){ // meters from last saved point
+			// if we have travelled more than distance_sensitivity
+			// meters then accumulate that distance
+
+			// get elapsed time since last sampling period
+			QTime last= saved_update.updateTime();
+			QTime t= update.updateTime();
+			delta= last.msecsTo(t);
+			
+			// get distance from last sample period, however long it takes
+			qreal dist= saved_update.coordinate().distanceTo(update.coordinate());
+			qDebug("delta time= %d ms, dist= %10.6f m", delta, dist);
+			if(dist > distance_sensitivity){
+				total += dist;
+				qDebug("1: cur dist: %10.6f, total: %10.6f", dist, total);
+				saved_update= update;
+				partial_distance= -1.0;
+			}else{
+				// the partial distance, (ie the unaccumulated part)
+				partial_distance= dist;
+			}
+			changed= true;
+				
+		}else{ 
+			// get the speed calculated from the GPS, and use it to
+			// determine the distance covered since the last valid speed update
+			if(update.dataValidityFlags() & QWhereaboutsUpdate::GroundSpeed){
+				// get elapsed time since last update
+				QTime last= last_update.updateTime();
+				QTime t= update.updateTime();
+				delta= last.msecsTo(t);
+
+				// get measured speed
+				qreal speed= update.groundSpeed();
+				qDebug("delta time= %d ms, speed= %10.6f m.s", delta, speed);
+
+				// if we are going less than the speed threshold then presume
+				// we are not moving
+				if(speed < speed_threshold){
+					speed= 0.0;
+				}
+
+				// calculate distance travelled
+				qreal d= speed * (delta/1000.0);
+				total += d;
+				qDebug("2: cur dist: %10.6f, total: %10.6f", d, total);
+			}
+		}
+	}
+	last_update= update;
+	return changed;
+}
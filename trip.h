@@ -0,0 +1,40 @@
+#ifndef TRIP_H
+#define TRIP_H
+
+#include <QWhereaboutsUpdate>
+
+// Accumulates the trip distance from GPS updates, kept apart from the
+// UI so a recorded track can be replayed through it
+class Trip
+{
+ public:
+	Trip();
+	void setSensitivity(int meters) { distance_sensitivity= meters; }
+	void setSpeedThreshold(double mps) { speed_threshold= mps; }
+
+	// start again from zero
+	void reset();
+	// forget the last fix so the time paused is not counted as travelled
+	void pause();
+	// carry on from a distance already travelled, eg after a restart
+	void restore(qreal distance);
+
+	// returns true if the partial distance changed
+	bool update(const QWhereaboutsUpdate &update);
+
+	qreal distance() const { return total; }
+	// distance moved but not yet accumulated, or -1 if there is none
+	qreal partial() const { return partial_distance; }
+	// accumulated plus partial distance, how far along the trip we are now
+	qreal travelled() const { return total + qMax(partial_distance, (qreal)0.0); }
+
+ private:
+	QWhereaboutsUpdate last_update;
+	QWhereaboutsUpdate saved_update;
+	qreal total;
+	qreal partial_distance;
+	double speed_threshold;
+	int distance_sensitivity;
+};
+
+#endif